@@ -10,16 +10,50 @@
 #include "../host.hpp"
 #include "../utils/sockaddr.hpp"
 #include "../utils/makeError.hpp"
+#include "../utils/copy.hpp"
+#include "../utils/ancillary.hpp"
 #include "dci/poll/descriptor/native.hpp"
 #include "sendBuffer.hpp"
+#include "peerChannel.hpp"
 
 namespace dci::module::net::datagram
 {
+    namespace
+    {
+        uint64 monotonicNow()
+        {
+            return static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        const api::Endpoint* sourceOf(const api::datagram::Datagram& datagram)
+        {
+            return datagram.local.holds<api::NullEndpoint>() ? nullptr : &datagram.local;
+        }
+
+        //first datagrams of the send queue, as a batch
+        struct QueueHead
+        {
+            const std::deque<api::datagram::Datagram>&  _queue;
+            std::size_t                                 _amount;
+
+            std::size_t size() const
+            {
+                return _amount;
+            }
+
+            const api::datagram::Datagram& operator[](std::size_t index) const
+            {
+                return _queue[index];
+            }
+        };
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     Channel::Channel(Host * host)
         : api::datagram::Channel<>::Opposite{idl::interface::Initializer{}}
         , _host{host}
         , _sock{{}, [this](poll::descriptor::Native native, poll::descriptor::ReadyStateFlags readyState){sockReady(native, readyState);}, nullptr}
+        , _timer{std::chrono::nanoseconds{}, false, [this]{timerTick();}}
     {
         _host->track(this);
 
@@ -32,11 +66,21 @@ namespace dci::module::net::datagram
                 {
                     return cmt::readyFuture<None>(e);
                 }
+            }
+            else
+            {
+                pushOption(op);
+            }
 
-                return cmt::readyFuture(None{});
+            if(op.holds<api::option::ReceiveCoalescing>())
+            {
+                _receiveCoalescing = op.get<api::option::ReceiveCoalescing>().enable;
+            }
+            else if(op.holds<api::option::TxTime>())
+            {
+                _txTime = op.get<api::option::TxTime>().enable;
             }
 
-            pushOption(op);
             return cmt::readyFuture(None{});
         };
 
@@ -53,6 +97,49 @@ namespace dci::module::net::datagram
             return cmt::readyFuture(None{});
         };
 
+        methods()->connect() += this * [&](const api::Endpoint& peer)
+        {
+            if(!_opened)
+            {
+                if(peer.holds<api::NullEndpoint>())
+                {
+                    return utils::makeError<None, api::NotConnected>("not connected");
+                }
+
+                ExceptionPtr e = open(nullptr, &peer);
+                if(e)
+                {
+                    return cmt::readyFuture<None>(e);
+                }
+            }
+
+            union
+            {
+                sockaddr            _base;
+                sockaddr_storage    _space;
+            } saddr;
+            socklen_t saddrLen = utils::sockaddr::convert(peer, &saddr._base);
+
+            //AF_UNSPEC dissolves the association
+            if(::connect(_sock.native(), &saddr._base, saddrLen ? saddrLen : sizeof(saddr._base)))
+            {
+                _connected = false;
+                _connectedPeer = api::Endpoint{};
+                return utils::fetchSystemError<None>();
+            }
+
+            _connected = !!saddrLen;
+            _connectedPeer = _connected ? peer : api::Endpoint{};
+
+            if(_connected)
+            {
+                //all further datagrams come from the peer, it is known without conversion
+                _peerCache.put(&saddr._base, saddrLen, peer);
+            }
+
+            return cmt::readyFuture(None{});
+        };
+
         methods()->localEndpoint() += this * [&]()
         {
             if(!_opened)
@@ -80,7 +167,138 @@ namespace dci::module::net::datagram
             return cmt::readyFuture(_localEndpoint);
         };
 
-        methods()->send() += this * [&](const Bytes& data, const api::Endpoint& peer)
+        methods()->send() += this * [&](auto&& data, const api::Endpoint& peer)
+        {
+            if(!_opened)
+            {
+                ExceptionPtr e = open(nullptr, &peer);
+                if(e)
+                {
+                    failed(e);
+                    return;
+                }
+            }
+
+            sendOrEnqueue(std::forward<decltype(data)>(data), peer);
+        };
+
+        methods()->sendConnected() += this * [&](auto&& data)
+        {
+            if(!_connected)
+            {
+                failed(utils::makeError<api::NotConnected>("not connected"));
+                return;
+            }
+
+            //no address at all, the kernel uses association and cached route
+            sendOrEnqueue(std::forward<decltype(data)>(data), api::NullEndpoint{});
+        };
+
+        methods()->sendFrom() += this * [&](auto&& data, const api::Endpoint& peer, const api::Endpoint& local)
+        {
+            if(!_opened)
+            {
+                ExceptionPtr e = open(nullptr, &peer);
+                if(e)
+                {
+                    failed(e);
+                    return;
+                }
+            }
+
+            sendOrEnqueue(std::forward<decltype(data)>(data), peer, 0, local.holds<api::NullEndpoint>() ? nullptr : &local);
+        };
+
+        methods()->sendBatch() += this * [&](const List<api::datagram::Datagram>& batch)
+        {
+            if(batch.empty())
+            {
+                return;
+            }
+
+            if(!_opened)
+            {
+                ExceptionPtr e = open(nullptr, &batch.front().peer);
+                if(e)
+                {
+                    failed(e);
+                    return;
+                }
+            }
+
+            if(!_txTime)
+            {
+                uint64 now = monotonicNow();
+                if(std::any_of(batch.begin(), batch.end(), [&](const api::datagram::Datagram& d){return d.timestamp > now;}))
+                {
+                    //transmit times are kept by timer
+                    for(const api::datagram::Datagram& d : batch)
+                    {
+                        if(d.timestamp > now)
+                        {
+                            _scheduled.emplace(d.timestamp, api::datagram::Datagram{d.data, d.peer, 0, d.local});
+                        }
+                        else if(!enqueue(api::datagram::Datagram{d.data, d.peer, 0, d.local}))
+                        {
+                            return;
+                        }
+                    }
+
+                    if(!_sendQueue.empty() && (poll::descriptor::rsf_write & _lastReadyState))
+                    {
+                        flushQueue(_sock.native());
+                    }
+
+                    if(_opened)
+                    {
+                        armTimer();
+                    }
+                    return;
+                }
+            }
+
+            std::size_t done = 0;
+            if(!_pacingRate && _sendQueue.empty() && (poll::descriptor::rsf_write & _lastReadyState))
+            {
+                done = doSendBatch(_sock.native(), batch);
+            }
+
+            for(; done < batch.size() && _opened; ++done)
+            {
+                if(!enqueue(api::datagram::Datagram{batch[done]}))
+                {
+                    break;
+                }
+            }
+
+            if(_pacingRate && _opened && (poll::descriptor::rsf_write & _lastReadyState))
+            {
+                flushQueue(_sock.native());
+            }
+        };
+
+        methods()->sendSegmented() += this * [&](const Bytes& data, uint32 segmentSize, const api::Endpoint& peer)
+        {
+            if(!segmentSize || segmentSize > std::numeric_limits<uint16>::max())
+            {
+                failed(utils::makeError<api::InvalidArgument>("bad segment size"));
+                return;
+            }
+
+            if(!_opened)
+            {
+                ExceptionPtr e = open(nullptr, &peer);
+                if(e)
+                {
+                    failed(e);
+                    return;
+                }
+            }
+
+            doSendSegmented(_sock.native(), data, segmentSize, peer);
+        };
+
+        methods()->sendAt() += this * [&](auto&& data, const api::Endpoint& peer, uint64 txTime)
         {
             if(!_opened)
             {
@@ -92,7 +310,84 @@ namespace dci::module::net::datagram
                 }
             }
 
-            doSend(_sock.native(), std::forward<decltype(data)>(data), peer);
+            if(!_txTime)
+            {
+                if(txTime > monotonicNow())
+                {
+                    _scheduled.emplace(txTime, api::datagram::Datagram{std::forward<decltype(data)>(data), peer, 0});
+                    armTimer();
+                    return;
+                }
+
+                txTime = 0;
+            }
+
+            sendOrEnqueue(std::forward<decltype(data)>(data), peer, txTime);
+        };
+
+        methods()->setPacingRate() += this * [&](uint64 bytesPerSecond)
+        {
+            _pacingRate = bytesPerSecond;
+
+            if(_opened && !_sendQueue.empty() && (poll::descriptor::rsf_write & _lastReadyState))
+            {
+                flushQueue(_sock.native());
+            }
+        };
+
+        methods()->setSendQueueLimit() += this * [&](uint32 bytes, uint32 packets)
+        {
+            _sendQueueBytesLimit = bytes;
+            _sendQueuePacketsLimit = packets;
+        };
+
+        methods()->setReceiveBudget() += this * [&](uint32 budget)
+        {
+            _receiveBudget = std::max(budget, uint32{1});
+        };
+
+        methods()->setBatchReceive() += this * [&](bool enable)
+        {
+            _batchReceive = enable;
+        };
+
+        methods()->peer() += this * [&](const api::Endpoint& peer)
+        {
+            union
+            {
+                sockaddr            _base;
+                sockaddr_storage    _space;
+            } saddr;
+            socklen_t saddrLen = utils::sockaddr::convert(peer, &saddr._base);
+
+            utils::sockaddr::Key key = utils::sockaddr::key(&saddr._base, saddrLen);
+            if(!key._size)
+            {
+                return utils::makeError<api::datagram::PeerChannel<>, api::InvalidArgument>("ip endpoint expected");
+            }
+
+            auto iter = _peers.find(key);
+            if(_peers.end() != iter)
+            {
+                return cmt::readyFuture(api::datagram::PeerChannel<>(*iter->second));
+            }
+
+            PeerChannel* p = new PeerChannel{this, key, peer};
+            p->involvedChanged() += p * [p](bool v)
+            {
+                if(!v)
+                {
+                    delete p;
+                }
+            };
+
+            _peers.emplace(key, p);
+            return cmt::readyFuture(api::datagram::PeerChannel<>(*p));
+        };
+
+        methods()->droppedCount() += this * [&]()
+        {
+            return cmt::readyFuture(_dropped);
         };
 
         methods()->close() += this * [&]()
@@ -105,10 +400,61 @@ namespace dci::module::net::datagram
     Channel::~Channel()
     {
         sbs::Owner::flush();
+        closePeers();
         _sock.close();
         _host->untrack(this);
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::sendToPeer(const Bytes& data, const api::Endpoint& peer)
+    {
+        if(!_opened)
+        {
+            ExceptionPtr e = open(nullptr, &peer);
+            if(e)
+            {
+                failed(e);
+                return;
+            }
+        }
+
+        sendOrEnqueue(data, peer);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::sendToPeer(Bytes&& data, const api::Endpoint& peer)
+    {
+        if(!_opened)
+        {
+            ExceptionPtr e = open(nullptr, &peer);
+            if(e)
+            {
+                failed(e);
+                return;
+            }
+        }
+
+        sendOrEnqueue(std::move(data), peer);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::peerClosed(const utils::sockaddr::Key& key)
+    {
+        _peers.erase(key);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::closePeers()
+    {
+        Peers peers;
+        peers.swap(_peers);
+
+        for(auto& [key, peerChannel] : peers)
+        {
+            peerChannel->detach();
+        }
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void Channel::failed(ExceptionPtr e, bool doClose)
     {
@@ -123,7 +469,12 @@ namespace dci::module::net::datagram
                 _opened = false;
             }
 
+            _lastReadyState = {};
+            _connected = false;
+            _connectedPeer = api::Endpoint{};
             _sock.close();
+            dropQueue();
+            closePeers();
         }
 
         si->failed(e);
@@ -137,7 +488,12 @@ namespace dci::module::net::datagram
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void Channel::close()
     {
+        _lastReadyState = {};
+        _connected = false;
+        _connectedPeer = api::Endpoint{};
         _sock.close();
+        dropQueue();
+        closePeers();
 
         if(_opened)
         {
@@ -156,7 +512,8 @@ namespace dci::module::net::datagram
 #ifdef _WIN32
         dci::poll::descriptor::Native native = ::WSASocketW(utils::sockaddr::family(bind ? *bind : *peer), SOCK_DGRAM, PF_UNSPEC, nullptr, 0, WSA_FLAG_NO_HANDLE_INHERIT);
 #else
-        dci::poll::descriptor::Native native = ::socket(utils::sockaddr::family(bind ? *bind : *peer), SOCK_DGRAM|SOCK_NONBLOCK|SOCK_CLOEXEC, PF_UNSPEC);
+        int family = utils::sockaddr::family(bind ? *bind : *peer);
+        dci::poll::descriptor::Native native = ::socket(family, SOCK_DGRAM|SOCK_NONBLOCK|SOCK_CLOEXEC, PF_UNSPEC);
 #endif
         if(native._bad == native._value)
         {
@@ -177,6 +534,21 @@ namespace dci::module::net::datagram
             return e;
         }
 
+#ifndef _WIN32
+        {
+            //drop counter in every received cmsg, best effort
+            int v = 1;
+            ::setsockopt(native, SOL_SOCKET, SO_RXQ_OVFL, &v, sizeof(v));
+            _droppedKernel = 0;
+        }
+
+        //pktinfo destinations take the port of this socket, known after bind
+        _localPort = 0;
+
+        //local datagrams may be far above 64K
+        _local = AF_UNIX == family;
+#endif
+
         if(bind)
         {
             union
@@ -195,15 +567,18 @@ namespace dci::module::net::datagram
         }
 
         _opened = true;
+        _connected = false;
+        _connectedPeer = api::Endpoint{};
+        _lastReadyState = poll::descriptor::rsf_write;//optimistic, a fresh socket has space
         return ExceptionPtr{};
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
-    void Channel::doSend(poll::descriptor::Native native, const Bytes& data, const api::Endpoint& peer)
+    bool Channel::doSend(poll::descriptor::Native native, const Bytes& data, const api::Endpoint& peer, uint64 txTime, const api::Endpoint* source)
     {
         if(data.empty())
         {
-            return;
+            return true;
         }
 
         union
@@ -216,16 +591,27 @@ namespace dci::module::net::datagram
         SendBuffer* sendBuffer = _host->getDatagramSendBuffer();
 
 #ifdef _WIN32
+        (void)txTime;
+        (void)source;
 #else
-        msghdr msg = {&saddr._base, saddrLen, sendBuffer->bufs(), 0, nullptr, 0, 0};
+        msghdr msg = {saddrLen ? &saddr._base : nullptr, saddrLen, sendBuffer->bufs(), 0, nullptr, 0, 0};
+
+        alignas(cmsghdr) char control[128];
+        std::size_t controlSize = utils::ancillary::build(control, sizeof(control), 0, txTime, source);
+        if(controlSize)
+        {
+            msg.msg_control = control;
+            msg.msg_controllen = controlSize;
+        }
 #endif
 
+        bool corked = false;
         bytes::Cursor src = data.begin();
         while(SendBuffer::SourceUtilization::partial == sendBuffer->fillFrom(src))
         {
 #ifdef _WIN32
             DWORD sent{};
-            ssize_t res = ::WSASendTo(native, sendBuffer->bufs(), sendBuffer->bufsAmount(), &sent, MSG_PARTIAL, &saddr._base, saddrLen, nullptr, nullptr);
+            ssize_t res = ::WSASendTo(native, sendBuffer->bufs(), sendBuffer->bufsAmount(), &sent, MSG_PARTIAL, saddrLen ? &saddr._base : nullptr, saddrLen, nullptr, nullptr);
             if(!res)
             {
                 res = sent;
@@ -240,14 +626,16 @@ namespace dci::module::net::datagram
             {
                 std::error_code ec = utils::fetchSystemErrorCode();
                 failed(utils::makeError(ec), ec != std::errc::resource_unavailable_try_again);
-                return;
+                return true;
             }
+
+            corked = true;
         }
 
 #ifdef _WIN32
         dbgAssert(sendBuffer->bufsAmount());
         DWORD sent{};
-        ssize_t res = ::WSASendTo(native, sendBuffer->bufs(), sendBuffer->bufsAmount(), &sent, 0, &saddr._base, saddrLen, nullptr, nullptr);
+        ssize_t res = ::WSASendTo(native, sendBuffer->bufs(), sendBuffer->bufsAmount(), &sent, 0, saddrLen ? &saddr._base : nullptr, saddrLen, nullptr, nullptr);
         if(!res)
         {
             res = sent;
@@ -262,45 +650,627 @@ namespace dci::module::net::datagram
         if(0 > res)
         {
             std::error_code ec = utils::fetchSystemErrorCode();
+            if(ec == std::errc::resource_unavailable_try_again && !corked)
+            {
+                //nothing corked yet, the datagram may wait in the queue
+                _lastReadyState &= ~poll::descriptor::rsf_write;
+                return false;
+            }
+
             failed(utils::makeError(ec), ec != std::errc::resource_unavailable_try_again);
-            return;
         }
+
+        return true;
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
-    void Channel::doRecv(poll::descriptor::Native native)
+    template <class Data>
+    void Channel::sendOrEnqueue(Data&& data, const api::Endpoint& peer, uint64 txTime, const api::Endpoint* source)
     {
-        union
-        {
-            sockaddr            _base;
-            sockaddr_storage    _space;
-        } saddr;
-        socklen_t saddrLen = sizeof(saddr);
-
-        auto recvBuffer = _host->getRecvBuffer();
-#ifdef _WIN32
-        DWORD received{};
-        DWORD flags{};
-        ssize_t res = ::WSARecvFrom(native, recvBuffer->bufs(), recvBuffer->bufsAmount(), &received, &flags, &saddr._base, &saddrLen, nullptr, nullptr);
-        if(!res)
+        if(!_pacingRate && _sendQueue.empty() && (poll::descriptor::rsf_write & _lastReadyState))
         {
-            res = received;
+            if(doSend(_sock.native(), data, peer, txTime, source))
+            {
+                return;
+            }
         }
-#else
-        msghdr msg = {&saddr._base, saddrLen, recvBuffer->bufs(), recvBuffer->bufsAmount(), nullptr, 0, 0};
-        ssize_t res = ::recvmsg(native, &msg, 0);
-        saddrLen = msg.msg_namelen;
-#endif
-        if(0 > res)
+
+        if(!enqueue(api::datagram::Datagram{std::forward<Data>(data), peer, txTime, source ? *source : api::Endpoint{}}))
         {
-            failed(utils::fetchSystemError(), true);
             return;
         }
 
-        api::Endpoint peer;
-        utils::sockaddr::convert(&saddr._base, saddrLen, peer);
-
-        methods()->received(recvBuffer->detach(static_cast<uint32>(res)), peer);
+        if(_pacingRate && (poll::descriptor::rsf_write & _lastReadyState))
+        {
+            flushQueue(_sock.native());
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    template <class Datagrams>
+    std::size_t Channel::doSendBatch(poll::descriptor::Native native, const Datagrams& batch)
+    {
+        std::size_t done = 0;
+
+#ifdef _WIN32
+        for(; done < batch.size() && _opened; ++done)
+        {
+            if(!doSend(native, batch[done].data, batch[done].peer, 0, sourceOf(batch[done])))
+            {
+                break;
+            }
+        }
+#else
+        SendBuffer* sendBuffer = _host->getDatagramSendBuffer();
+
+        while(done < batch.size())
+        {
+            //empty datagrams are not sent, as in doSend
+            if(batch[done].data.empty())
+            {
+                ++done;
+                continue;
+            }
+
+            std::size_t end = done;
+            while(end < batch.size() && !batch[end].data.empty() && sendBuffer->push(batch[end].data, batch[end].peer, _txTime ? batch[end].timestamp : 0, sourceOf(batch[end])))
+            {
+                ++end;
+            }
+
+            if(end == done)
+            {
+                //more chunks than iovecs, the same as a partial sending in doSend
+                if(!doSend(native, batch[done].data, batch[done].peer, _txTime ? batch[done].timestamp : 0, sourceOf(batch[done])))
+                {
+                    break;
+                }
+
+                if(!_opened)
+                {
+                    return batch.size();
+                }
+
+                ++done;
+                continue;
+            }
+
+            int res = ::sendmmsg(native, sendBuffer->msgs(), sendBuffer->msgsAmount(), 0);
+            sendBuffer->clear();
+
+            if(0 > res)
+            {
+                std::error_code ec = utils::fetchSystemErrorCode();
+                if(ec == std::errc::resource_unavailable_try_again)
+                {
+                    _lastReadyState &= ~poll::descriptor::rsf_write;
+                    break;
+                }
+
+                failed(utils::makeError(ec), true);
+                return batch.size();
+            }
+
+            done += static_cast<std::size_t>(res);
+        }
+#endif
+
+        return done;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::doSendSegmented(poll::descriptor::Native native, const Bytes& data, uint32 segmentSize, const api::Endpoint& peer)
+    {
+        uint32 size = static_cast<uint32>(data.size());
+        uint32 done = 0;
+        bytes::Cursor src = data.begin();
+
+#ifndef _WIN32
+        SendBuffer* sendBuffer = _host->getDatagramSendBuffer();
+
+        int family = utils::sockaddr::family(peer.holds<api::NullEndpoint>() ? _connectedPeer : peer);
+        bool gso = !_gsoUnsupported && (AF_INET == family || AF_INET6 == family);
+
+        while(done < size && !_pacingRate && _sendQueue.empty() && (poll::descriptor::rsf_write & _lastReadyState))
+        {
+            //with gso one message carries up to _gsoSegmentsMax segments, without - exactly one
+            uint32 groupSize = gso ?
+                                   std::min(_gsoSegmentsMax, std::max(_gsoDataMax / segmentSize, uint32{1})) * segmentSize :
+                                   segmentSize;
+
+            bytes::Cursor mark = src;
+            uint32 batched = 0;
+            while(done + batched < size)
+            {
+                uint32 len = std::min(groupSize, size - done - batched);
+                if(!sendBuffer->push(src, len, peer, static_cast<uint16>(gso && len > segmentSize ? segmentSize : 0)))
+                {
+                    break;
+                }
+                batched += len;
+            }
+
+            if(!batched)
+            {
+                break;
+            }
+
+            uint32 amount = sendBuffer->msgsAmount();
+            int res = ::sendmmsg(native, sendBuffer->msgs(), amount, 0);
+            sendBuffer->clear();
+
+            if(0 > res)
+            {
+                src = mark;
+
+                std::error_code ec = utils::fetchSystemErrorCode();
+                if(ec == std::errc::resource_unavailable_try_again)
+                {
+                    _lastReadyState &= ~poll::descriptor::rsf_write;
+                    break;
+                }
+
+                if(gso && (ec == std::errc::io_error ||
+                           ec == std::errc::invalid_argument ||
+                           ec == std::errc::no_protocol_option ||
+                           ec == std::errc::operation_not_supported))
+                {
+                    //no gso on this path, slice here
+                    _gsoUnsupported = true;
+                    gso = false;
+                    continue;
+                }
+
+                failed(utils::makeError(ec), true);
+                return;
+            }
+
+            uint32 sent = std::min(static_cast<uint32>(res) * groupSize, batched);
+            if(static_cast<uint32>(res) < amount)
+            {
+                src = mark;
+                src.advance(sent);
+            }
+            done += sent;
+        }
+#endif
+
+        //the rest waits in the queue as ordinary datagrams
+        while(done < size && _opened)
+        {
+            uint32 len = std::min(segmentSize, size - done);
+
+            done += len;
+
+            if(!enqueue(api::datagram::Datagram{utils::copy(src, len), peer}))
+            {
+                return;
+            }
+        }
+
+        if(!_sendQueue.empty() && (poll::descriptor::rsf_write & _lastReadyState))
+        {
+            flushQueue(native);
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::enqueue(api::datagram::Datagram&& datagram)
+    {
+        if((_sendQueueBytesLimit && _sendQueueBytes + datagram.data.size() > _sendQueueBytesLimit) ||
+           (_sendQueuePacketsLimit && _sendQueue.size() >= _sendQueuePacketsLimit))
+        {
+            _writableWanted = true;
+            failed(utils::makeError<api::UnavaliableTryAgain>("send queue is full"));
+            return false;
+        }
+
+        _sendQueueBytes += datagram.data.size();
+        _sendQueue.emplace_back(std::move(datagram));
+        _writableWanted = true;
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::flushQueue(poll::descriptor::Native native)
+    {
+        std::size_t amount = _pacingRate ? pacedAmount(monotonicNow()) : _sendQueue.size();
+
+        std::size_t done = amount ? doSendBatch(native, QueueHead{_sendQueue, amount}) : 0;
+        if(!_opened)
+        {
+            return;
+        }
+
+        for(std::size_t i(0); i<done && !_sendQueue.empty(); ++i)
+        {
+            if(_pacingRate)
+            {
+                _pacingNext += pacingCost(_sendQueue.front().data.size());
+            }
+
+            _sendQueueBytes -= _sendQueue.front().data.size();
+            _sendQueue.pop_front();
+        }
+
+        if(_pacingRate && !_sendQueue.empty())
+        {
+            armTimer();
+        }
+
+        if(_sendQueue.empty() && _writableWanted)
+        {
+            _writableWanted = false;
+            methods()->writable();
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::dropQueue()
+    {
+        _sendQueue.clear();
+        _sendQueueBytes = 0;
+        _writableWanted = false;
+
+        _scheduled.clear();
+        _pacingNext = 0;
+        _timer.stop();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::size_t Channel::pacedAmount(uint64 now)
+    {
+        dbgAssert(_pacingRate);
+
+        //no credit is accumulated while idle beyond one quantum
+        _pacingNext = std::max(_pacingNext, now > _pacingQuantum ? now - _pacingQuantum : 0);
+
+        std::size_t amount = 0;
+        for(uint64 next = _pacingNext; amount < _sendQueue.size() && next <= now; ++amount)
+        {
+            next += pacingCost(_sendQueue[amount].data.size());
+        }
+
+        return amount;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint64 Channel::pacingCost(std::size_t size) const
+    {
+        return static_cast<uint64>(size) * 1000000000 / _pacingRate;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::armTimer()
+    {
+        uint64 at = std::numeric_limits<uint64>::max();
+
+        if(!_scheduled.empty())
+        {
+            at = _scheduled.begin()->first;
+        }
+
+        if(_pacingRate && !_sendQueue.empty() && (poll::descriptor::rsf_write & _lastReadyState))
+        {
+            at = std::min(at, _pacingNext);
+        }
+
+        _timer.stop();
+
+        if(std::numeric_limits<uint64>::max() != at)
+        {
+            uint64 now = monotonicNow();
+            _timer.interval(std::chrono::nanoseconds{at > now ? at - now : 0});
+            _timer.start();
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::timerTick()
+    {
+        uint64 now = monotonicNow();
+        while(_opened && !_scheduled.empty() && _scheduled.begin()->first <= now)
+        {
+            auto node = _scheduled.extract(_scheduled.begin());
+            if(!enqueue(std::move(node.mapped())))
+            {
+                break;
+            }
+        }
+
+        if(_opened && !_sendQueue.empty() && (poll::descriptor::rsf_write & _lastReadyState))
+        {
+            flushQueue(_sock.native());
+        }
+
+        if(_opened)
+        {
+            armTimer();
+        }
+    }
+
+#ifndef _WIN32
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    const api::Endpoint* Channel::destinationOf(sockaddr* address, socklen_t addressLen)
+    {
+        if(!addressLen)
+        {
+            return nullptr;
+        }
+
+        //pktinfo has no port, it is the bound one
+        if(!_localPort)
+        {
+            union
+            {
+                sockaddr            _base;
+                sockaddr_in         _in;
+                sockaddr_in6        _in6;
+                sockaddr_storage    _space;
+            } saddr;
+            socklen_t saddrLen = sizeof(saddr);
+            if(!::getsockname(_sock.native(), &saddr._base, &saddrLen))
+            {
+                _localPort = AF_INET6 == saddr._base.sa_family ? saddr._in6.sin6_port : saddr._in.sin_port;
+            }
+        }
+
+        if(AF_INET6 == address->sa_family)
+        {
+            reinterpret_cast<sockaddr_in6*>(address)->sin6_port = _localPort;
+        }
+        else
+        {
+            reinterpret_cast<sockaddr_in*>(address)->sin_port = _localPort;
+        }
+
+        return &_destinationCache.get(address, addressLen);
+    }
+#endif
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::deliver(Bytes&& data, const api::Endpoint& peer, uint64 timestamp, const api::Endpoint* destination, List<api::datagram::Datagram>& batch)
+    {
+        if(_batchReceive && _peers.empty())
+        {
+            batch.emplace_back(api::datagram::Datagram{std::move(data), peer, timestamp, destination ? *destination : api::Endpoint{}});
+            return true;
+        }
+
+        if(!batch.empty())
+        {
+            //a peer channel appeared during the batch, what came before goes first
+            methods()->receivedBatch(std::move(batch));
+            batch.clear();
+            if(!_opened)
+            {
+                return false;
+            }
+        }
+
+        if(destination)
+        {
+            methods()->destination(*destination);
+            if(!_opened)
+            {
+                return false;
+            }
+        }
+
+        if(timestamp)
+        {
+            methods()->timestamp(timestamp);
+            if(!_opened)
+            {
+                return false;
+            }
+        }
+
+        if(!_peers.empty())
+        {
+            //demultiplexing is on, the peer has no own channel yet
+            methods()->newPeer(peer, std::move(data));
+            return _opened;
+        }
+
+        methods()->received(std::move(data), peer);
+        return _opened;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::updateDropped(uint32 droppedKernel)
+    {
+        //kernel counter is 32 bit and wraps, total is accumulated by deltas
+        uint32 delta = droppedKernel - _droppedKernel;
+        if(!delta)
+        {
+            return true;
+        }
+
+        _droppedKernel = droppedKernel;
+        _dropped += delta;
+
+        methods()->dropped(_dropped, delta);
+        return _opened;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::doRecv(poll::descriptor::Native native)
+    {
+#ifdef _WIN32
+        union
+        {
+            sockaddr            _base;
+            sockaddr_storage    _space;
+        } saddr;
+        socklen_t saddrLen = sizeof(saddr);
+
+        auto recvBuffer = _host->getRecvBuffer();
+        DWORD received{};
+        DWORD flags{};
+        ssize_t res = ::WSARecvFrom(native, recvBuffer->bufs(), recvBuffer->bufsAmount(), &received, &flags, &saddr._base, &saddrLen, nullptr, nullptr);
+        if(!res)
+        {
+            res = received;
+        }
+
+        //one datagram per readiness, the level triggered poll reports the rest
+        _lastReadyState &= ~poll::descriptor::rsf_read;
+
+        if(0 > res)
+        {
+            DWORD lastError = WSAGetLastError();
+            if(WSAEWOULDBLOCK != lastError && WSATRY_AGAIN != lastError)
+            {
+                failed(utils::fetchSystemError(), true);
+            }
+            return;
+        }
+
+        if(!_peers.empty())
+        {
+            auto iter = _peers.find(utils::sockaddr::key(&saddr._base, saddrLen));
+            if(_peers.end() != iter)
+            {
+                iter->second->deliver(recvBuffer->detach(static_cast<uint32>(res)));
+                return;
+            }
+        }
+
+        api::Endpoint peer = _peerCache.get(&saddr._base, saddrLen);
+
+        List<api::datagram::Datagram> batch;
+        if(deliver(recvBuffer->detach(static_cast<uint32>(res)), peer, 0, nullptr, batch) && !batch.empty())
+        {
+            methods()->receivedBatch(std::move(batch));
+        }
+#else
+        RecvBuffer* recvBuffer = _local ? _host->getLocalRecvBuffer() : _host->getDatagramRecvBuffer();
+        List<api::datagram::Datagram> batch;
+
+        ExceptionPtr error;
+        bool drained = false;
+
+        uint32 budget = _receiveBudget;
+        while(budget && !drained)
+        {
+            uint32 requested = std::min(budget, recvBuffer->msgsAmount());
+
+            //with coalescing iovecs are laid out by the last seen segment size, so the split is zero-copy
+            recvBuffer->prepare(_receiveCoalescing ? _coalescedSegmentSize : 0);
+            int res = ::recvmmsg(native, recvBuffer->msgs(), requested, 0, nullptr);
+            if(0 > res)
+            {
+                std::error_code ec = utils::fetchSystemErrorCode();
+                if(ec != std::errc::resource_unavailable_try_again)
+                {
+                    error = utils::makeError(ec);
+                }
+
+                drained = true;
+                break;
+            }
+
+            budget -= static_cast<uint32>(res);
+            drained = static_cast<uint32>(res) < requested;
+
+            for(uint32 i(0); i<static_cast<uint32>(res); ++i)
+            {
+                mmsghdr& msg = recvBuffer->msgs()[i];
+                utils::ancillary::Values ancillary = utils::ancillary::parse(msg.msg_hdr);
+
+                if(ancillary._droppedFetched && !updateDropped(ancillary._dropped))
+                {
+                    return;
+                }
+
+                if(MSG_TRUNC & msg.msg_hdr.msg_flags)
+                {
+                    //larger than a slot, the tail is lost, a part is not delivered as a whole datagram
+                    failed(utils::makeError<api::InvalidArgument>("datagram truncated"));
+                    if(!_opened)
+                    {
+                        return;
+                    }
+
+                    continue;
+                }
+
+                const api::Endpoint* destination = destinationOf(&ancillary._destination._base, ancillary._destinationLen);
+
+                //peer channels are found by the raw address, without conversion
+                utils::sockaddr::Key key;
+                if(!_peers.empty())
+                {
+                    key = utils::sockaddr::key(recvBuffer->address(i), recvBuffer->addressLen(i));
+                }
+
+                auto dispatch = [&](Bytes&& data)
+                {
+                    if(key._size)
+                    {
+                        auto iter = _peers.find(key);
+                        if(_peers.end() != iter)
+                        {
+                            iter->second->deliver(std::move(data));
+                            return _opened;
+                        }
+                    }
+
+                    api::Endpoint peer = _peerCache.get(recvBuffer->address(i), recvBuffer->addressLen(i));
+                    return deliver(std::move(data), peer, ancillary._timestamp, destination, batch);
+                };
+
+                if(ancillary._segmentSize && msg.msg_len > ancillary._segmentSize)
+                {
+                    _coalescedSegmentSize = ancillary._segmentSize;
+
+                    List<Bytes> segments;
+                    recvBuffer->detachSegments(i, ancillary._segmentSize, segments);
+                    for(Bytes& segment : segments)
+                    {
+                        if(!dispatch(std::move(segment)))
+                        {
+                            return;
+                        }
+                    }
+
+                    continue;
+                }
+
+                if(!dispatch(recvBuffer->detach(i)))
+                {
+                    return;
+                }
+            }
+        }
+
+        if(drained)
+        {
+            _lastReadyState &= ~poll::descriptor::rsf_read;
+        }
+
+        if(!batch.empty())
+        {
+            methods()->receivedBatch(std::move(batch));
+            if(!_opened)
+            {
+                return;
+            }
+        }
+
+        if(error)
+        {
+            failed(error, true);
+            return;
+        }
+
+        if(!drained)
+        {
+            //budget exhausted, continue on the next loop iteration
+            _sock.emitReady();
+        }
+#endif
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
@@ -329,6 +1299,11 @@ namespace dci::module::net::datagram
 
         if(poll::descriptor::rsf_close & readyState)
         {
+            _lastReadyState = {};
+            dropQueue();
+            closePeers();
+            _connected = false;
+            _connectedPeer = api::Endpoint{};
             _opened = false;
             _localEndpoint = api::Endpoint();
             _localEndpointFetched = false;
@@ -337,7 +1312,18 @@ namespace dci::module::net::datagram
             return;
         }
 
-        if(poll::descriptor::rsf_read & readyState)
+        _lastReadyState |= readyState;
+
+        if((poll::descriptor::rsf_write & _lastReadyState) && !_sendQueue.empty())
+        {
+            flushQueue(native);
+            if(!_opened)
+            {
+                return;
+            }
+        }
+
+        if(poll::descriptor::rsf_read & _lastReadyState)
         {
             doRecv(native);
         }
@@ -10,6 +10,8 @@
 #include "dci/poll/descriptor/native.hpp"
 #include "../optionsStore.hpp"
 #include "../utils/recvBuffer.hpp"
+#include "../utils/sockaddr.hpp"
+#include "sendBuffer.hpp"
 
 namespace dci::module::net
 {
@@ -17,6 +19,8 @@ namespace dci::module::net
 
     namespace datagram
     {
+        class PeerChannel;
+
         class Channel
             : public api::datagram::Channel<>::Opposite
             , public sbs::Owner
@@ -27,12 +31,38 @@ namespace dci::module::net
             Channel(Host* host);
             ~Channel();
 
+        public:
+            void sendToPeer(const Bytes& data, const api::Endpoint& peer);
+            void sendToPeer(Bytes&& data, const api::Endpoint& peer);
+            void peerClosed(const utils::sockaddr::Key& key);
+
         private:
             void failed(ExceptionPtr e, bool doClose = false);
             void close();
+            void closePeers();
 
             ExceptionPtr open(const api::Endpoint* bind = nullptr, const api::Endpoint* peer = nullptr);
-            void doSend(poll::descriptor::Native native, const Bytes& data, const api::Endpoint& peer);
+            bool doSend(poll::descriptor::Native native, const Bytes& data, const api::Endpoint& peer, uint64 txTime = 0, const api::Endpoint* source = nullptr);
+
+            template <class Data>
+            void sendOrEnqueue(Data&& data, const api::Endpoint& peer, uint64 txTime = 0, const api::Endpoint* source = nullptr);
+
+            template <class Datagrams>
+            std::size_t doSendBatch(poll::descriptor::Native native, const Datagrams& batch);
+
+            void doSendSegmented(poll::descriptor::Native native, const Bytes& data, uint32 segmentSize, const api::Endpoint& peer);
+
+            bool enqueue(api::datagram::Datagram&& datagram);
+            void flushQueue(poll::descriptor::Native native);
+            void dropQueue();
+
+            std::size_t pacedAmount(uint64 now);
+            uint64 pacingCost(std::size_t size) const;
+            void armTimer();
+            void timerTick();
+            const api::Endpoint* destinationOf(sockaddr* address, socklen_t addressLen);
+            bool deliver(Bytes&& data, const api::Endpoint& peer, uint64 timestamp, const api::Endpoint* destination, List<api::datagram::Datagram>& batch);
+            bool updateDropped(uint32 droppedKernel);
             void doRecv(poll::descriptor::Native native);
             void sockReady(poll::descriptor::Native native, poll::descriptor::ReadyStateFlags readyState);
 
@@ -40,9 +70,46 @@ namespace dci::module::net
             Host *              _host;
             poll::Descriptor    _sock;
             api::Endpoint       _localEndpoint;
+            api::Endpoint       _connectedPeer;
+
+            utils::sockaddr::Cache  _peerCache;
+            utils::sockaddr::Cache  _destinationCache;
+            uint16                  _localPort = 0;//network order, for destinations
+            bool                    _local = false;//AF_UNIX, receives into the large local slots
+
+            using Peers = std::unordered_map<utils::sockaddr::Key, PeerChannel*, utils::sockaddr::KeyHash>;
+            Peers                   _peers;
+
+            poll::descriptor::ReadyStateFlags   _lastReadyState{};
+            uint32                              _receiveBudget = 256;
+            bool                                _batchReceive = false;
+
+            std::deque<api::datagram::Datagram> _sendQueue;
+            uint64                              _sendQueueBytes = 0;
+            uint32                              _sendQueueBytesLimit = 4*1024*1024;
+            uint32                              _sendQueuePacketsLimit = 4096;
+            bool                                _writableWanted = false;
+
+            static constexpr uint32             _gsoSegmentsMax = 64;//UDP_MAX_SEGMENTS
+            static constexpr uint32             _gsoDataMax = 65000;
+            bool                                _gsoUnsupported = false;
+
+            bool                                _txTime = false;
+            uint64                              _pacingRate = 0;
+            uint64                              _pacingNext = 0;
+            static constexpr uint64             _pacingQuantum = 1000000;//ns of idle credit, the burst allowed after a pause
+            std::multimap<uint64, api::datagram::Datagram> _scheduled;
+            poll::Timer                         _timer;
+
+            bool                                _receiveCoalescing = false;
+            uint32                              _coalescedSegmentSize = 0;
+
+            uint32                              _droppedKernel = 0;
+            uint64                              _dropped = 0;
 
             bool                _opened = false;
             bool                _localEndpointFetched = false;
+            bool                _connected = false;
         };
     }
 }
@@ -0,0 +1,86 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "peerChannel.hpp"
+#include "channel.hpp"
+#include "../utils/makeError.hpp"
+
+namespace dci::module::net::datagram
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    PeerChannel::PeerChannel(Channel* channel, const utils::sockaddr::Key& key, const api::Endpoint& peer)
+        : api::datagram::PeerChannel<>::Opposite{idl::interface::Initializer{}}
+        , _channel{channel}
+        , _key{key}
+        , _peer{peer}
+    {
+        methods()->peer() += this * [&]()
+        {
+            return cmt::readyFuture(_peer);
+        };
+
+        methods()->stats() += this * [&]()
+        {
+            return cmt::readyFuture(_stats);
+        };
+
+        methods()->send() += this * [&](auto&& data)
+        {
+            if(!_channel)
+            {
+                methods()->failed(utils::makeError<api::NotConnected>("channel closed"));
+                return;
+            }
+
+            _stats.sentDatagrams++;
+            _stats.sentBytes += data.size();
+
+            _channel->sendToPeer(std::forward<decltype(data)>(data), _peer);
+        };
+
+        methods()->close() += this * [&]()
+        {
+            if(_channel)
+            {
+                _channel->peerClosed(_key);
+                _channel = nullptr;
+                methods()->closed();
+            }
+        };
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    PeerChannel::~PeerChannel()
+    {
+        sbs::Owner::flush();
+
+        if(_channel)
+        {
+            _channel->peerClosed(_key);
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PeerChannel::deliver(Bytes&& data)
+    {
+        _stats.receivedDatagrams++;
+        _stats.receivedBytes += data.size();
+
+        methods()->received(std::move(data));
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PeerChannel::detach()
+    {
+        if(_channel)
+        {
+            _channel = nullptr;
+            methods()->closed();
+        }
+    }
+}
@@ -0,0 +1,34 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+#include "../utils/sockaddr.hpp"
+
+namespace dci::module::net::datagram
+{
+    class Channel;
+
+    class PeerChannel
+        : public api::datagram::PeerChannel<>::Opposite
+        , public sbs::Owner
+        , public mm::heap::Allocable<PeerChannel>
+    {
+    public:
+        PeerChannel(Channel* channel, const utils::sockaddr::Key& key, const api::Endpoint& peer);
+        ~PeerChannel();
+
+        void deliver(Bytes&& data);
+        void detach();
+
+    private:
+        Channel *                   _channel;
+        utils::sockaddr::Key        _key;
+        api::Endpoint               _peer;
+        api::datagram::PeerStats    _stats{};
+    };
+}
@@ -0,0 +1,269 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "recvBuffer.hpp"
+#include "../utils/copy.hpp"
+
+#ifndef _WIN32
+namespace dci::module::net::datagram
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    RecvBuffer::RecvBuffer(uint32 overflowSize)
+        : _overflowSize{overflowSize}
+    {
+        for(uint32 i(0); i<_slotsAmount; ++i)
+        {
+            _slots[i]._overflow.reset(new char[_overflowSize]);
+
+            _msgs[i].msg_hdr = {&_slots[i]._address._base, sizeof(_slots[i]._address), _slots[i]._bufs, 0, _slots[i]._control, _controlSize, 0};
+            _msgs[i].msg_len = 0;
+        }
+
+        setMtu(_defaultMtu);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    RecvBuffer::~RecvBuffer()
+    {
+        for(Slot& slot : _slots)
+        {
+            for(bytes::Chunk* c : slot._chunks)
+            {
+                delete c;
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void RecvBuffer::setMtu(uint32 mtu)
+    {
+        mtu = std::min(mtu ? mtu : _defaultMtu, _maxDataSize);
+
+        uint32 headBufs = (mtu + _bufSize - 1) / _bufSize;
+        if(headBufs != _headBufs)
+        {
+            _headBufs = headBufs;
+            if(!_segmentSize)
+            {
+                relayout(0);
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void RecvBuffer::prepare(uint32 segmentSize)
+    {
+        //aligned layout must still fit the largest coalesced datagram
+        if(segmentSize && _slotBufsAmount / ((segmentSize + _bufSize - 1) / _bufSize) * segmentSize < _maxDataSize)
+        {
+            segmentSize = 0;
+        }
+
+        if(segmentSize != _segmentSize)
+        {
+            relayout(segmentSize);
+        }
+
+        for(mmsghdr& msg : _msgs)
+        {
+            msg.msg_hdr.msg_namelen = sizeof(Slot::_address);
+            msg.msg_hdr.msg_controllen = _controlSize;
+            msg.msg_hdr.msg_flags = 0;
+            msg.msg_len = 0;
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    mmsghdr* RecvBuffer::msgs()
+    {
+        return &_msgs[0];
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 RecvBuffer::msgsAmount() const
+    {
+        return _slotsAmount;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    const sockaddr* RecvBuffer::address(uint32 index) const
+    {
+        dbgAssert(index < _slotsAmount);
+        return &_slots[index]._address._base;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    socklen_t RecvBuffer::addressLen(uint32 index) const
+    {
+        dbgAssert(index < _slotsAmount);
+        return _msgs[index].msg_hdr.msg_namelen;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Bytes RecvBuffer::detach(uint32 index)
+    {
+        dbgAssert(index < _slotsAmount);
+
+        uint32 size = _msgs[index].msg_len;
+        if(!size)
+        {
+            return Bytes{};
+        }
+
+        uint32 bufsUsed = 0;
+        uint32 headSize = _layoutBufs * _bufSize;
+        Bytes res = link(index, 0, std::min(size, headSize), bufsUsed);
+        renew(index, bufsUsed);
+
+        if(size > headSize)
+        {
+            //larger than mtu, the tail is in the overflow area
+            dbgAssert(!_segmentSize);
+            res.end().write(_slots[index]._overflow.get(), size - headSize);
+        }
+
+        return res;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void RecvBuffer::detachSegments(uint32 index, uint32 segmentSize, List<Bytes>& dst)
+    {
+        dbgAssert(index < _slotsAmount);
+        dbgAssert(segmentSize);
+
+        uint32 size = _msgs[index].msg_len;
+
+        if(segmentSize != _segmentSize)
+        {
+            //layout does not match, split by copying
+            Bytes whole = detach(index);
+            bytes::Cursor src = whole.begin();
+            for(uint32 offset(0); offset < size; offset += segmentSize)
+            {
+                dst.emplace_back(utils::copy(src, std::min(segmentSize, size - offset)));
+            }
+            return;
+        }
+
+        //every segment is in own chunks already, just cut the chain
+        uint32 firstBuf = 0;
+        uint32 bufsUsed = 0;
+        for(uint32 offset(0); offset < size; offset += segmentSize)
+        {
+            dst.emplace_back(link(index, firstBuf, std::min(segmentSize, size - offset), bufsUsed));
+            firstBuf += _segmentBufs;
+        }
+
+        renew(index, bufsUsed);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 RecvBuffer::bufLen(uint32 bufIndex) const
+    {
+        if(!_segmentSize)
+        {
+            return _bufSize;
+        }
+
+        uint32 inSegment = bufIndex % _segmentBufs;
+        if(inSegment + 1 < _segmentBufs)
+        {
+            return _bufSize;
+        }
+
+        return _segmentSize - inSegment * _bufSize;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void RecvBuffer::relayout(uint32 segmentSize)
+    {
+        _segmentSize = segmentSize;
+        _segmentBufs = segmentSize ? (segmentSize + _bufSize - 1) / _bufSize : 1;
+
+        //plain layout: mtu sized head in chunks and the overflow area behind it
+        //aligned layout: whole segments in chunks, no overflow
+        _layoutBufs = segmentSize ? _slotBufsAmount / _segmentBufs * _segmentBufs : _headBufs;
+
+        for(uint32 i(0); i<_slotsAmount; ++i)
+        {
+            Slot& slot = _slots[i];
+
+            for(uint32 j(0); j<_layoutBufs; ++j)
+            {
+                bytes::Chunk*& cur = slot._chunks[j];
+                if(!cur)
+                {
+                    cur = new bytes::Chunk{nullptr, nullptr, 0, _bufSize};
+                }
+
+                slot._bufs[j].data() = reinterpret_cast<Buf::Data>(cur->data());
+                slot._bufs[j].len() = bufLen(j);
+            }
+
+            uint32 iovlen = _layoutBufs;
+            if(!segmentSize)
+            {
+                slot._bufs[iovlen].data() = reinterpret_cast<Buf::Data>(slot._overflow.get());
+                slot._bufs[iovlen].len() = _overflowSize;
+                ++iovlen;
+            }
+
+            _msgs[i].msg_hdr.msg_iovlen = iovlen;
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Bytes RecvBuffer::link(uint32 index, uint32 firstBuf, uint32 size, uint32& bufsUsed)
+    {
+        dbgAssert(size);
+
+        Slot& slot = _slots[index];
+
+        bytes::Chunk* first = slot._chunks[firstBuf];
+        bytes::Chunk* prev = nullptr;
+        uint32 rest = size;
+        uint32 i = firstBuf;
+        for(; rest && i < _layoutBufs; ++i)
+        {
+            bytes::Chunk* cur = slot._chunks[i];
+            uint32 len = std::min(static_cast<uint32>(slot._bufs[i].len()), rest);
+
+            cur->setEnd(static_cast<uint16>(len));
+            cur->setPrev(prev);
+            cur->setNext(nullptr);
+            if(prev)
+            {
+                prev->setNext(cur);
+            }
+
+            prev = cur;
+            rest -= len;
+        }
+
+        bufsUsed = i;
+        return Bytes{first, prev, size - rest};
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void RecvBuffer::renew(uint32 index, uint32 bufsAmount)
+    {
+        dbgAssert(bufsAmount <= _layoutBufs);
+        Slot& slot = _slots[index];
+
+        //only consumed chunks are replaced, untouched rest stays for the next datagram
+        for(uint32 i(0); i<bufsAmount; ++i)
+        {
+            bytes::Chunk *&cur = slot._chunks[i];
+            cur = new bytes::Chunk{nullptr, nullptr, 0, _bufSize};
+
+            slot._bufs[i].data() = reinterpret_cast<Buf::Data>(cur->data());
+            slot._bufs[i].len() = bufLen(i);
+        }
+    }
+}
+#endif
@@ -0,0 +1,81 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+
+#ifndef _WIN32
+namespace dci::module::net::datagram
+{
+    class RecvBuffer
+    {
+        RecvBuffer(const RecvBuffer&) = delete;
+        void operator=(const RecvBuffer&) = delete;
+
+    public:
+        //overflowSize - largest datagram beyond the mtu head, 64K fits any ip one
+        RecvBuffer(uint32 overflowSize = _maxDataSize);
+        ~RecvBuffer();
+
+        //mtu - expected datagram size, only this much is received into chunks, larger ones go through overflow area
+        void setMtu(uint32 mtu);
+
+        //segmentSize - expected size of coalesced segments, iovecs are laid out so every segment has own chunks
+        void prepare(uint32 segmentSize = 0);
+
+        mmsghdr* msgs();
+        uint32 msgsAmount() const;
+
+        const sockaddr* address(uint32 index) const;
+        socklen_t addressLen(uint32 index) const;
+
+        Bytes detach(uint32 index);
+        void detachSegments(uint32 index, uint32 segmentSize, List<Bytes>& dst);
+
+    private:
+        uint32 bufLen(uint32 bufIndex) const;
+        void relayout(uint32 segmentSize);
+        Bytes link(uint32 index, uint32 firstBuf, uint32 size, uint32& bufsUsed);
+        void renew(uint32 index, uint32 bufsAmount);
+
+    private:
+        static constexpr uint32 _bufSize = bytes::Chunk::bufferSize();
+        static constexpr uint32 _maxDataSize = 65536;
+        static constexpr uint32 _maxSegments = 64;//UDP_GRO_CNT_MAX
+        static constexpr uint32 _slotBufsAmount = std::max((_maxDataSize + _bufSize - 1) / _bufSize, _maxSegments);
+        static constexpr uint32 _slotsAmount = 16;
+        static constexpr uint32 _controlSize = 256;
+        static constexpr uint32 _defaultMtu = 1500;
+
+    private:
+        struct Slot
+        {
+            bytes::Chunk*   _chunks[_slotBufsAmount] = {};
+            Buf             _bufs[_slotBufsAmount + 1];//+1 for overflow
+
+            std::unique_ptr<char[]> _overflow;
+
+            union
+            {
+                sockaddr            _base;
+                sockaddr_storage    _space;
+            } _address;
+
+            alignas(cmsghdr) char _control[_controlSize];
+        };
+
+        Slot    _slots[_slotsAmount];
+        mmsghdr _msgs[_slotsAmount];
+
+        uint32  _overflowSize;
+        uint32  _headBufs = 0;
+        uint32  _segmentSize = 0;
+        uint32  _segmentBufs = 1;
+        uint32  _layoutBufs = 0;
+    };
+}
+#endif
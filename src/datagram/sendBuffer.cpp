@@ -7,6 +7,8 @@
 
 #include "pch.hpp"
 #include "sendBuffer.hpp"
+#include "../utils/sockaddr.hpp"
+#include "../utils/ancillary.hpp"
 
 namespace dci::module::net::datagram
 {
@@ -67,9 +69,91 @@ namespace dci::module::net::datagram
         return _bufsAmount;
     }
 
+#ifndef _WIN32
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool SendBuffer::push(const Bytes& data, const api::Endpoint& peer, uint64 txTime, const api::Endpoint* source)
+    {
+        bytes::Cursor src = data.begin();
+        return push(src, static_cast<uint32>(data.size()), peer, 0, txTime, source);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool SendBuffer::push(bytes::Cursor& src, uint32 size, const api::Endpoint& peer, uint16 segmentSize, uint64 txTime, const api::Endpoint* source)
+    {
+        if(_msgsAmount >= _msgsAmountMax)
+        {
+            return false;
+        }
+
+        bytes::Cursor cur = src;
+        uint32 bufsAmount = _bufsAmount;
+        uint32 rest = size;
+        while(rest)
+        {
+            dbgAssert(!cur.atEnd());
+
+            if(bufsAmount >= _bufsAmountMax)
+            {
+                return false;
+            }
+
+            uint32 len = std::min(static_cast<uint32>(cur.continuousDataSize()), rest);
+
+            _bufs[bufsAmount].data() = reinterpret_cast<Buf::Data>(const_cast<byte*>(cur.continuousData()));
+            _bufs[bufsAmount].len() = len;
+
+            if(len < cur.continuousDataSize())
+            {
+                cur.advance(len);
+            }
+            else
+            {
+                cur.advanceChunks(1);
+            }
+
+            rest -= len;
+            bufsAmount++;
+        }
+
+        Address& address = _addresses[_msgsAmount];
+        socklen_t addressLen = utils::sockaddr::convert(peer, &address._base);
+
+        msghdr& msg = _msgs[_msgsAmount].msg_hdr;
+        msg = {addressLen ? &address._base : nullptr, addressLen, &_bufs[_bufsAmount], bufsAmount - _bufsAmount, nullptr, 0, 0};
+        _msgs[_msgsAmount].msg_len = 0;
+
+        std::size_t controlSize = utils::ancillary::build(_controls[_msgsAmount]._data, _controlSize, segmentSize, txTime, source);
+        if(controlSize)
+        {
+            msg.msg_control = _controls[_msgsAmount]._data;
+            msg.msg_controllen = controlSize;
+        }
+
+        src = cur;
+        _bufsAmount = bufsAmount;
+        _msgsAmount++;
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    mmsghdr* SendBuffer::msgs()
+    {
+        return &_msgs[0];
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 SendBuffer::msgsAmount() const
+    {
+        return _msgsAmount;
+    }
+#endif
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void SendBuffer::clear()
     {
         _bufsAmount = 0;
+#ifndef _WIN32
+        _msgsAmount = 0;
+#endif
     }
 }
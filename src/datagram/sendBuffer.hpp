@@ -31,6 +31,16 @@ namespace dci::module::net::datagram
         Buf* bufs();
         uint32 bufsAmount() const;
 
+#ifndef _WIN32
+        //whole message per push, false if it does not fit into the rest of buffer
+        //txTime - SO_TXTIME transmit time, 0 - none; source - local address to send from, nullptr - any
+        bool push(const Bytes& data, const api::Endpoint& peer, uint64 txTime = 0, const api::Endpoint* source = nullptr);
+        bool push(bytes::Cursor& src, uint32 size, const api::Endpoint& peer, uint16 segmentSize = 0, uint64 txTime = 0, const api::Endpoint* source = nullptr);
+
+        mmsghdr* msgs();
+        uint32 msgsAmount() const;
+#endif
+
         void clear();
 
     private:
@@ -39,5 +49,27 @@ namespace dci::module::net::datagram
     private:
         Buf     _bufs[_bufsAmountMax];
         uint32  _bufsAmount = 0;
+
+#ifndef _WIN32
+        static constexpr uint32 _msgsAmountMax = 256;
+
+        union Address
+        {
+            sockaddr            _base;
+            sockaddr_storage    _space;
+        };
+
+        static constexpr uint32 _controlSize = 128;
+
+        struct alignas(cmsghdr) Control
+        {
+            char _data[_controlSize];
+        };
+
+        mmsghdr _msgs[_msgsAmountMax];
+        Address _addresses[_msgsAmountMax];
+        Control _controls[_msgsAmountMax];
+        uint32  _msgsAmount = 0;
+#endif
     };
 }
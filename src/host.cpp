@@ -11,9 +11,25 @@
 #include "stream/client.hpp"
 #include "stream/channel.hpp"
 #include "datagram/channel.hpp"
+#include "utils/makeError.hpp"
+#include <fstream>
 
 namespace dci::module::net
 {
+#ifndef _WIN32
+    namespace
+    {
+        //a local datagram is limited by the sender buffer, SO_SNDBUF is doubled and capped by net.core.wmem_max
+        uint32 maxLocalDatagram()
+        {
+            uint64 wmemMax = 0;
+            std::ifstream{"/proc/sys/net/core/wmem_max"} >> wmemMax;
+
+            return static_cast<uint32>(std::clamp(wmemMax * 2, uint64{65536}, uint64{64*1024*1024}));
+        }
+    }
+#endif
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     Host::Host()
         : api::Host<>::Opposite(idl::interface::Initializer())
@@ -47,6 +63,40 @@ namespace dci::module::net
             return cmt::readyFuture(api::stream::Client<>(*c));
         };
 
+        methods()->seqpacketServer() += this * [this]()
+        {
+#ifdef _WIN32
+            return utils::makeError<api::stream::Server<>, api::OperationNotSupported>("seqpacket is not supported on this platform");
+#else
+            stream::Server* s = new stream::Server{this, true};
+            s->involvedChanged() += s * [s](bool v)
+            {
+                if(!v)
+                {
+                    delete s;
+                }
+            };
+            return cmt::readyFuture(api::stream::Server<>(*s));
+#endif
+        };
+
+        methods()->seqpacketClient() += this * [this]()
+        {
+#ifdef _WIN32
+            return utils::makeError<api::stream::Client<>, api::OperationNotSupported>("seqpacket is not supported on this platform");
+#else
+            stream::Client* c = new stream::Client{this, true};
+            c->involvedChanged() += c * [c](bool v)
+            {
+                if(!v)
+                {
+                    delete c;
+                }
+            };
+            return cmt::readyFuture(api::stream::Client<>(*c));
+#endif
+        };
+
         methods()->datagramChannel() += this * [this]()
         {
             datagram::Channel* c = new datagram::Channel{this};
@@ -143,6 +193,20 @@ namespace dci::module::net
         _datagramChannels.erase(_datagramChannels.find(v));
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    stream::Server* Host::inProcessServer(const api::Endpoint& endpoint)
+    {
+        for(stream::Server* s : _streamServers)
+        {
+            if(s->servesInProcess(endpoint))
+            {
+                return s;
+            }
+        }
+
+        return nullptr;
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     utils::RecvBuffer* Host::getRecvBuffer()
     {
@@ -154,4 +218,25 @@ namespace dci::module::net
     {
         return &_datagramSendBuffer;
     }
+
+#ifndef _WIN32
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    datagram::RecvBuffer* Host::getDatagramRecvBuffer()
+    {
+        _datagramRecvBuffer.setMtu(_links.maxMtu());
+        return &_datagramRecvBuffer;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    datagram::RecvBuffer* Host::getLocalRecvBuffer()
+    {
+        //overflow areas are large but stay untouched until such a datagram comes
+        if(!_localRecvBuffer)
+        {
+            _localRecvBuffer.reset(new datagram::RecvBuffer{maxLocalDatagram()});
+        }
+
+        return _localRecvBuffer.get();
+    }
+#endif
 }
@@ -24,6 +24,7 @@
 
 #include "utils/recvBuffer.hpp"
 #include "datagram/sendBuffer.hpp"
+#include "datagram/recvBuffer.hpp"
 
 namespace dci::module::net
 {
@@ -48,8 +49,15 @@ namespace dci::module::net
         void track(datagram::Channel* v);
         void untrack(datagram::Channel* v);
 
+        //own server listening on the endpoint with InProcess option, or nullptr
+        stream::Server* inProcessServer(const api::Endpoint& endpoint);
+
         utils::RecvBuffer* getRecvBuffer();
         datagram::SendBuffer* getDatagramSendBuffer();
+#ifndef _WIN32
+        datagram::RecvBuffer* getDatagramRecvBuffer();
+        datagram::RecvBuffer* getLocalRecvBuffer();//AF_UNIX datagrams and seqpacket messages, every slot takes the largest one
+#endif
 
     private:
         Links                   _links;
@@ -68,6 +76,10 @@ namespace dci::module::net
 
         utils::RecvBuffer       _recvBuffer;
         datagram::SendBuffer    _datagramSendBuffer;
+#ifndef _WIN32
+        datagram::RecvBuffer    _datagramRecvBuffer;
+        std::unique_ptr<datagram::RecvBuffer> _localRecvBuffer;
+#endif
 
     };
 }
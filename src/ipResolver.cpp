@@ -16,7 +16,9 @@ namespace dci::module::net
     IpResolver::IpResolver(api::Host<>::Opposite* iface)
         : _iface(iface)
     {
-        _workers.emplace_back(std::thread(&IpResolver::workerProc, this));
+#ifndef _WIN32
+        _hosts.watch("/etc/hosts");
+#endif
 
         (*_iface)->resolveIp() += this * [&](auto&& endpoint)
         {
@@ -47,6 +49,94 @@ namespace dci::module::net
         {
             return execute<List<api::Ip6Endpoint>>(std::forward<decltype(endpoint)>(endpoint));
         };
+
+        (*_iface)->resolveMany() += this * [&](List<String> endpoints)
+        {
+            auto* b = new Batch{_cache, _batches};
+            auto res = b->init(std::move(endpoints), _timeout);
+
+            if(!b->submit())
+            {
+                delete b;
+            }
+
+            return res;
+        };
+
+        (*_iface)->setResolveTimeout() += this * [&](uint64 milliseconds)
+        {
+            _timeout = std::chrono::milliseconds{milliseconds};
+#ifndef _WIN32
+            if(_stub)
+            {
+                _stub->setBudget(_timeout);
+            }
+#endif
+        };
+
+        (*_iface)->setResolveWorkers() += this * [&](uint32 max)
+        {
+            std::unique_lock l(_mtx);
+            _maxWorkers = std::max(max, uint32{1});
+        };
+
+        (*_iface)->resolveStats() += this * [&]()
+        {
+            return cmt::readyFuture(stats());
+        };
+
+        (*_iface)->setResolveStub() += this * [&](bool enable)
+        {
+#ifdef _WIN32
+            (void)enable;
+#else
+            //resolv.conf is reread on every enabling, hosts come from the watched index
+            _stub.reset(enable ? new Stub{_nameservers, _hosts, _timeout} : nullptr);
+#endif
+        };
+
+        (*_iface)->setResolveNameservers() += this * [&](List<api::IpEndpoint> servers)
+        {
+            _nameservers = std::move(servers);
+#ifndef _WIN32
+            if(_stub)
+            {
+                _stub.reset(new Stub{_nameservers, _hosts, _timeout});
+            }
+#endif
+        };
+
+        (*_iface)->setResolveHostsFile() += this * [&](String path)
+        {
+            if(path.empty())
+            {
+                _hosts.unwatch();
+                _hosts.load("");
+                return;
+            }
+
+            _hosts.watch(path.c_str());
+        };
+
+        (*_iface)->setResolveCacheTtl() += this * [&](uint64 positiveMilliseconds, uint64 negativeMilliseconds)
+        {
+            _cache->setTtl(std::chrono::milliseconds{positiveMilliseconds}, std::chrono::milliseconds{negativeMilliseconds});
+        };
+
+        (*_iface)->setResolveCacheSize() += this * [&](uint32 max)
+        {
+            _cache->setCapacity(max);
+        };
+
+        (*_iface)->flushResolveCache() += this * [&]()
+        {
+            _cache->flush();
+        };
+
+        (*_iface)->resolveCacheEntries() += this * [&]()
+        {
+            return cmt::readyFuture(_cache->entries());
+        };
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
@@ -54,6 +144,18 @@ namespace dci::module::net
     {
         flush();
 
+#ifndef _WIN32
+        _stub.reset();
+#endif
+
+        //late lookups and their notifications must not outlive the resolver
+        while(!_batches.empty())
+        {
+            ipResolver::Batch* b = *_batches.begin();
+            b->abandon();
+            delete b;
+        }
+
         //cancel all
         {
             std::unique_lock l(_mtx);
@@ -61,26 +163,77 @@ namespace dci::module::net
         }
         _notifier4Worker.notify_all();
 
-        for(std::thread& t : _workers)
+        for(auto& [id, t] : _workers)
         {
             t.join();
         }
         _workers.clear();
+        _exitedWorkers.clear();
 
-        if(_tasks4Worker)
+        while(_tasks4Worker)
         {
             ipResolver::Task* t = _tasks4Worker;
             _tasks4Worker = std::exchange(t->_next4Worker, {});
             t->resolve();
         }
+        _tasks4WorkerTail = nullptr;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void IpResolver::enqueue(ipResolver::Task* t)
+    {
+        {
+            std::unique_lock l(_mtx);
+
+            if(_tasks4WorkerTail)
+            {
+                _tasks4WorkerTail->_next4Worker = t;
+            }
+            else
+            {
+                _tasks4Worker = t;
+            }
+            _tasks4WorkerTail = t;
+
+            _queued++;
+            _queuedMax = std::max(_queuedMax, _queued);
+
+            joinExitedWorkers();
+            ensureWorkersRan();
+        }
+
+        _notifier4Worker.notify_one();
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void IpResolver::ensureWorkersRan()
     {
-        //not implemented, one thread always exists
+        //one more worker while the queue is deeper than idle ones may take, a slow lookup does not hold the rest
+        if(_queued > _idleWorkers && _workers.size() < _maxWorkers)
+        {
+            std::thread t(&IpResolver::workerProc, this);
+            std::thread::id id = t.get_id();
+            _workers.emplace(id, std::move(t));
+        }
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void IpResolver::joinExitedWorkers()
+    {
+        for(std::thread::id id : _exitedWorkers)
+        {
+            auto iter = _workers.find(id);
+            if(_workers.end() != iter)
+            {
+                //already out of the loop, only the thread end remains
+                iter->second.join();
+                _workers.erase(iter);
+            }
+        }
+        _exitedWorkers.clear();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void IpResolver::workerProc()
     {
         std::unique_lock l(_mtx);
@@ -90,15 +243,68 @@ namespace dci::module::net
             {
                 ipResolver::Task* t = _tasks4Worker;
                 _tasks4Worker = std::exchange(t->_next4Worker, {});
+                if(!_tasks4Worker)
+                {
+                    _tasks4WorkerTail = nullptr;
+                }
+                _queued--;
+
+                bool expired = t->expired();
+                if(expired)
+                {
+                    _expired++;
+                }
+                else
+                {
+                    _executed++;
+                }
 
                 l.unlock();
-                t->doWorkInThread();
+                if(expired)
+                {
+                    t->skipInThread();
+                }
+                else
+                {
+                    t->doWorkInThread();
+                }
                 l.lock();
             }
             else
             {
-                _notifier4Worker.wait(l);
+                _idleWorkers++;
+                std::cv_status status = _notifier4Worker.wait_for(l, _idleTimeout);
+                _idleWorkers--;
+
+                //shrink, the last one stays
+                if(std::cv_status::timeout == status && !_tasks4Worker && !_stopFlag && _workers.size() - _exitedWorkers.size() > 1)
+                {
+                    _exitedWorkers.push_back(std::this_thread::get_id());
+                    return;
+                }
             }
         }
     }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    api::ResolveStats IpResolver::stats()
+    {
+        std::unique_lock l(_mtx);
+
+        api::ResolveStats res;
+        res.queued = _queued;
+        res.queuedMax = _queuedMax;
+        res.workers = static_cast<uint32>(_workers.size() - _exitedWorkers.size());
+        res.idleWorkers = _idleWorkers;
+        res.executed = _executed;
+        res.expired = _expired;
+        res.cacheSize = _cache->size();
+        res.cacheHits = _cache->hits();
+        res.cacheMisses = _cache->misses();
+        res.coalesced = _coalesced;
+        res.hostsNames = _hosts.size();
+        res.hostsReloads = _hosts.reloads();
+        res.hostsHits = _hostsHits;
+        return res;
+    }
 }
@@ -8,6 +8,8 @@
 #pragma once
 #include "pch.hpp"
 #include "ipResolver/task.hpp"
+#include "ipResolver/stub.hpp"
+#include "ipResolver/batch.hpp"
 
 namespace dci::module::net
 {
@@ -24,14 +26,47 @@ namespace dci::module::net
         template <class Value>
         auto execute(auto&& endpoint);
 
+        void enqueue(ipResolver::Task* t);
         void ensureWorkersRan();
+        void joinExitedWorkers();
         void workerProc();
 
+        api::ResolveStats stats();
+
     private:
         api::Host<>::Opposite *     _iface = nullptr;
-        std::vector<std::thread>    _workers;
 
+        std::map<std::thread::id, std::thread>  _workers;
+        std::vector<std::thread::id>            _exitedWorkers;
+        uint32                                  _idleWorkers = 0;
+        uint32                                  _maxWorkers = 8;
+
+        ipResolver::Hosts                       _hosts;
+        uint64                                  _hostsHits = 0;
+
+        List<api::IpEndpoint>                   _nameservers;
+#ifndef _WIN32
+        std::unique_ptr<ipResolver::Stub>       _stub;
+#endif
+
+        //getaddrinfo_a submissions in flight
+        std::unordered_set<ipResolver::Batch*>  _batches;
+
+        //shared with tasks, a late one may outlive the resolver
+        std::shared_ptr<ipResolver::Cache>      _cache = std::make_shared<ipResolver::Cache>();
+
+        static constexpr std::chrono::seconds   _idleTimeout{30};
+        std::chrono::milliseconds               _timeout{30000};
+
+        //fifo
         ipResolver::Task*           _tasks4Worker = nullptr;
+        ipResolver::Task*           _tasks4WorkerTail = nullptr;
+        uint32                      _queued = 0;
+        uint32                      _queuedMax = 0;
+
+        uint64                      _executed = 0;
+        uint64                      _expired = 0;
+        uint64                      _coalesced = 0;
 
         std::mutex                  _mtx;
         std::condition_variable     _notifier4Worker;
@@ -48,21 +83,61 @@ namespace dci::module::net
             return cmt::readyFuture(Value{});
         }
 
-        ensureWorkersRan();
-
         using namespace ipResolver;
 
-        auto* t = new Task;
-        auto res = t->init<Value>(std::forward<decltype(endpoint)>(endpoint));
+        //numeric, no task and no lookup
+        {
+            api::IpEndpoint numeric;
+            if(literal::endpoint(endpoint, numeric))
+            {
+                return literal::ready<Value>(numeric);
+            }
+        }
+
+        //names from the hosts file with a numeric port, no task either
+        {
+            std::string_view host;
+            std::string_view service;
+            literal::split(endpoint, host, service);
+
+            uint16 port;
+            List<api::IpEndpoint> found;
+            if(literal::port(service, port) && _hosts.lookup(host, Task::familyOf<Value>(), port, found))
+            {
+                Value v{};
+                Task::fetchEndpoint(v, found);
+                _hostsHits++;
+                return cmt::readyFuture(std::move(v));
+            }
+        }
+
+        auto* t = new Task{_cache};
+        auto res = t->init<Value>(std::forward<decltype(endpoint)>(endpoint), _timeout);
 
+        Cache::Key key = t->key();
+        if(t->resolveFromCache(key))
         {
-            std::unique_lock l(_mtx);
+            delete t;
+            return res;
+        }
 
-            t->_next4Worker = _tasks4Worker;
-            _tasks4Worker = t;
+        if(Task* leader = _cache->leader(key); leader && leader->joinable())
+        {
+            leader->attach(t);
+            _coalesced++;
+            return res;
+        }
+        _cache->lead(key, t);
+
+#ifndef _WIN32
+        if(_stub)
+        {
+            _stub->resolve(t);
+            return res;
         }
+#endif
 
-        _notifier4Worker.notify_one();
+        enqueue(t);
 
         return res;
     }
@@ -0,0 +1,328 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "batch.hpp"
+#include "task.hpp"
+#include "literal.hpp"
+
+namespace dci::module::net::ipResolver
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Batch::Batch(std::shared_ptr<Cache> cache, std::unordered_set<Batch*>& live)
+        : _cache(std::move(cache))
+        , _live(live)
+    {
+        _live.insert(this);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Batch::~Batch()
+    {
+        _live.erase(this);
+
+#ifndef _WIN32
+        if(_link)
+        {
+            std::unique_lock l(_link->_mtx);
+            if(_link->_notified)
+            {
+                l.unlock();
+                delete _link;
+            }
+            else
+            {
+                //canceled lists are never notified by glibc, the link is left to a late one
+                _link->_batch = nullptr;
+            }
+        }
+#endif
+
+        _deadlineTimer.stop();
+        _sol.flush();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    cmt::Future<List<api::ResolveResult>> Batch::init(List<String>&& endpoints, std::chrono::milliseconds timeout)
+    {
+        _results.resize(endpoints.size());
+        _requests.reserve(endpoints.size());
+
+        for(std::size_t i(0); i<endpoints.size(); ++i)
+        {
+            api::ResolveResult& result = _results[i];
+            result.endpoint = std::move(endpoints[i]);
+
+            if(result.endpoint.empty())
+            {
+                continue;
+            }
+
+            api::IpEndpoint numeric;
+            if(literal::endpoint(result.endpoint, numeric))
+            {
+                result.addresses.push_back(numeric);
+                continue;
+            }
+
+            std::string_view host;
+            std::string_view service;
+            literal::split(result.endpoint, host, service);
+
+            if(const Cache::Entry* entry = _cache->get(Cache::Key{String{host}, String{service}, AF_UNSPEC}))
+            {
+                if(entry->_resCode)
+                {
+                    result.error = gai_strerror(entry->_resCode);
+                }
+                else if(!Task::fetchEndpoint(result.addresses, entry->_endpoints))
+                {
+                    result.error = "unable to fetch endpoint info";
+                }
+                continue;
+            }
+
+            Request& request = _requests.emplace_back();
+            request._index = i;
+            request._host = host;
+            request._service = service;
+        }
+
+        memset(&_hint, 0, sizeof(_hint));
+        _hint.ai_flags = AI_ALL | AI_ADDRCONFIG;
+        _hint.ai_family = AF_UNSPEC;
+
+        _promise.canceled() += _sol * [this]
+        {
+            _canceled = true;
+        };
+
+        _awaker.woken() += _sol * [this]
+        {
+            completed();
+        };
+
+        if(timeout.count())
+        {
+            _deadlineTimer.interval(timeout);
+            _deadlineTimer.start();
+        }
+
+        return _promise.future();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Batch::submit()
+    {
+        if(_requests.empty())
+        {
+            _promise.resolveValue(std::move(_results));
+            return false;
+        }
+
+#ifdef _WIN32
+        for(Request& request : _requests)
+        {
+            _results[request._index].error = "batch resolution is not supported";
+        }
+        _promise.resolveValue(std::move(_results));
+        return false;
+#else
+        std::vector<gaicb*> list;
+        list.reserve(_requests.size());
+        for(Request& request : _requests)
+        {
+            request._cb.ar_name = request._host.c_str();
+            request._cb.ar_service = request._service.empty() ? nullptr : request._service.c_str();
+            request._cb.ar_request = &_hint;
+            list.push_back(&request._cb);
+        }
+
+        //one notification when the whole list is done
+        _link = new Link;
+        _link->_batch = this;
+
+        sigevent sev {};
+        sev.sigev_notify = SIGEV_THREAD;
+        sev.sigev_notify_function = &Batch::notify;
+        sev.sigev_value.sival_ptr = _link;
+
+        int res = getaddrinfo_a(GAI_NOWAIT, list.data(), static_cast<int>(list.size()), &sev);
+        if(res)
+        {
+            delete _link;
+            _link = nullptr;
+
+            for(Request& request : _requests)
+            {
+                fill(request, res);
+            }
+            _promise.resolveValue(std::move(_results));
+            return false;
+        }
+
+        return true;
+#endif
+    }
+
+#ifndef _WIN32
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Batch::notify(sigval v)
+    {
+        Link* link = static_cast<Link*>(v.sival_ptr);
+
+        std::unique_lock l(link->_mtx);
+        link->_notified = true;
+
+        if(!link->_batch)
+        {
+            l.unlock();
+            delete link;
+            return;
+        }
+
+        link->_batch->_awaker.wakeup();
+        link->_cv.notify_all();
+    }
+#endif
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Batch::abandon()
+    {
+#ifndef _WIN32
+        if(!_link)
+        {
+            return;
+        }
+
+        //queued lookups are dropped, running ones write into the requests, so they are waited for
+        bool someCanceled = false;
+        for(Request& request : _requests)
+        {
+            someCanceled |= EAI_CANCELED == gai_cancel(&request._cb);
+        }
+
+        for(;;)
+        {
+            std::vector<const gaicb*> inProgress;
+            for(Request& request : _requests)
+            {
+                if(EAI_INPROGRESS == gai_error(&request._cb))
+                {
+                    inProgress.push_back(&request._cb);
+                }
+            }
+
+            if(inProgress.empty())
+            {
+                break;
+            }
+
+            gai_suspend(inProgress.data(), static_cast<int>(inProgress.size()), nullptr);
+        }
+
+        for(Request& request : _requests)
+        {
+            if(request._cb.ar_result)
+            {
+                freeaddrinfo(request._cb.ar_result);
+                request._cb.ar_result = nullptr;
+            }
+        }
+
+        if(!someCanceled)
+        {
+            //all done, the notification is on its way and runs the module code
+            std::unique_lock l(_link->_mtx);
+            _link->_cv.wait(l, [this]{return _link->_notified;});
+        }
+#endif
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Batch::fill(Request& request, int resCode)
+    {
+        if(request._filled)
+        {
+            return;
+        }
+        request._filled = true;
+
+        List<api::IpEndpoint> endpoints;
+#ifndef _WIN32
+        if(!resCode)
+        {
+            endpoints = Task::endpoints(request._cb.ar_result);
+        }
+
+        if(request._cb.ar_result)
+        {
+            freeaddrinfo(request._cb.ar_result);
+            request._cb.ar_result = nullptr;
+        }
+#endif
+
+        _cache->put(Cache::Key{request._host, request._service, AF_UNSPEC}, resCode, endpoints);
+
+        api::ResolveResult& result = _results[request._index];
+        if(resCode)
+        {
+            result.error = gai_strerror(resCode);
+        }
+        else if(!Task::fetchEndpoint(result.addresses, endpoints))
+        {
+            result.error = "unable to fetch endpoint info";
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Batch::completed()
+    {
+        dci::utils::AtScopeExit continuation{[this]{delete this;}};
+
+#ifndef _WIN32
+        for(Request& request : _requests)
+        {
+            fill(request, gai_error(&request._cb));
+        }
+#endif
+
+        if(!_canceled && !_promise.resolved())
+        {
+            _promise.resolveValue(std::move(_results));
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Batch::deadline()
+    {
+        if(_canceled || _promise.resolved())
+        {
+            return;
+        }
+
+        //the late ones are not canceled, the batch lives until the notification
+        List<api::ResolveResult> results = _results;
+#ifndef _WIN32
+        for(Request& request : _requests)
+        {
+            int resCode = gai_error(&request._cb);
+            if(EAI_INPROGRESS == resCode)
+            {
+                results[request._index].error = "resolve deadline exceeded";
+            }
+            else
+            {
+                fill(request, resCode);
+                results[request._index] = _results[request._index];
+            }
+        }
+#endif
+
+        _promise.resolveValue(std::move(results));
+    }
+}
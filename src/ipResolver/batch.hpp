@@ -0,0 +1,78 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+#include "cache.hpp"
+
+namespace dci::module::net::ipResolver
+{
+    //many names in one getaddrinfo_a submission, completion comes through an awaker
+    class Batch
+    {
+    public:
+        Batch(std::shared_ptr<Cache> cache, std::unordered_set<Batch*>& live);
+        ~Batch();
+
+        cmt::Future<List<api::ResolveResult>> init(List<String>&& endpoints, std::chrono::milliseconds timeout);
+
+        //false - all done in place, the batch is not needed anymore
+        bool submit();
+
+        //resolver teardown, pending lookups are canceled or waited for, the batch is to be deleted then
+        void abandon();
+
+    private:
+        struct Request;
+
+#ifndef _WIN32
+        //the notification thread side, outlives the batch if the notification never comes
+        struct Link
+        {
+            std::mutex              _mtx;
+            std::condition_variable _cv;
+            Batch*                  _batch = nullptr;
+            bool                    _notified = false;
+        };
+
+        static void notify(sigval v);
+#endif
+        void fill(Request& request, int resCode);
+        void completed();
+        void deadline();
+
+    private:
+        std::shared_ptr<Cache>                  _cache;
+        std::unordered_set<Batch*>&             _live;
+#ifndef _WIN32
+        Link*                                   _link = nullptr;
+#endif
+
+        List<api::ResolveResult>                _results;
+
+        struct Request
+        {
+            std::size_t _index {};
+            String      _host;
+            String      _service;
+#ifndef _WIN32
+            gaicb       _cb {};
+#endif
+            bool        _filled {};
+        };
+        std::vector<Request>                    _requests;
+
+        addrinfo                                _hint {};
+
+        cmt::Promise<List<api::ResolveResult>>  _promise;
+        bool                                    _canceled = false;
+
+        poll::Timer                             _deadlineTimer{std::chrono::milliseconds{}, false, [this]{deadline();}};
+        poll::Awaker                            _awaker;
+        sbs::Owner                              _sol;
+    };
+}
@@ -0,0 +1,195 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "cache.hpp"
+
+namespace dci::module::net::ipResolver
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Cache::setTtl(std::chrono::milliseconds positive, std::chrono::milliseconds negative)
+    {
+        _positiveTtl = positive;
+        _negativeTtl = negative;
+        flush();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Cache::setCapacity(uint32 capacity)
+    {
+        _capacity = capacity;
+        shrink();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    const Cache::Entry* Cache::get(const Key& key)
+    {
+        auto iter = _index.find(key);
+        if(_index.end() == iter)
+        {
+            _misses++;
+            return nullptr;
+        }
+
+        Lru::iterator entry = iter->second;
+        if(std::chrono::steady_clock::now() >= entry->_expire)
+        {
+            _index.erase(iter);
+            _lru.erase(entry);
+            _misses++;
+            return nullptr;
+        }
+
+        _lru.splice(_lru.begin(), _lru, entry);
+        entry->_hits++;
+        _hits++;
+        return &*entry;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Cache::put(const Key& key, int resCode, const List<api::IpEndpoint>& endpoints, std::chrono::milliseconds ttl)
+    {
+        if(resCode && !remembered(resCode))
+        {
+            return;
+        }
+
+        ttl = std::min(ttl, resCode ? _negativeTtl : _positiveTtl);
+        if(!ttl.count() || !_capacity)
+        {
+            return;
+        }
+
+        auto iter = _index.find(key);
+        if(_index.end() != iter)
+        {
+            _lru.erase(iter->second);
+            _index.erase(iter);
+        }
+
+        _lru.push_front(Entry{key, resCode, endpoints, std::chrono::steady_clock::now() + ttl, 0});
+        _index.emplace(key, _lru.begin());
+
+        shrink();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Cache::flush()
+    {
+        _index.clear();
+        _lru.clear();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Task* Cache::leader(const Key& key) const
+    {
+        auto iter = _leaders.find(key);
+        return _leaders.end() == iter ? nullptr : iter->second;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Cache::lead(const Key& key, Task* task)
+    {
+        //a canceled leader is replaced, it finishes on its own
+        _leaders[key] = task;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Cache::unlead(const Key& key, Task* task)
+    {
+        auto iter = _leaders.find(key);
+        if(_leaders.end() != iter && task == iter->second)
+        {
+            _leaders.erase(iter);
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    List<api::ResolveCacheEntry> Cache::entries() const
+    {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+        List<api::ResolveCacheEntry> res;
+        for(const Entry& entry : _lru)
+        {
+            if(now >= entry._expire)
+            {
+                continue;
+            }
+
+            api::ResolveCacheEntry& dst = res.emplace_back();
+            dst.host = entry._key._host;
+            dst.service = entry._key._service;
+            dst.family = AF_INET == entry._key._family ? 4 : AF_INET6 == entry._key._family ? 6 : 0;
+            dst.negative = !!entry._resCode;
+            dst.hits = entry._hits;
+            dst.ttlLeft = static_cast<uint64>(std::chrono::duration_cast<std::chrono::milliseconds>(entry._expire - now).count());
+        }
+
+        return res;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 Cache::size() const
+    {
+        return static_cast<uint32>(_lru.size());
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint64 Cache::hits() const
+    {
+        return _hits;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint64 Cache::misses() const
+    {
+        return _misses;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Cache::remembered(int resCode)
+    {
+        //only definite answers, transient failures are asked again
+        switch(resCode)
+        {
+        case EAI_NONAME:
+        case EAI_SERVICE:
+#ifdef EAI_NODATA
+        case EAI_NODATA:
+#endif
+#ifdef EAI_ADDRFAMILY
+        case EAI_ADDRFAMILY:
+#endif
+            return true;
+
+        default:
+            break;
+        }
+
+        return false;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Cache::shrink()
+    {
+        while(_lru.size() > _capacity)
+        {
+            _index.erase(_lru.back()._key);
+            _lru.pop_back();
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::size_t Cache::KeyHash::operator()(const Key& key) const
+    {
+        std::size_t res = std::hash<std::string_view>{}(key._host);
+        res ^= std::hash<std::string_view>{}(key._service) + 0x9e3779b97f4a7c15ull + (res << 6) + (res >> 2);
+        res ^= static_cast<std::size_t>(key._family) + 0x9e3779b97f4a7c15ull + (res << 6) + (res >> 2);
+        return res;
+    }
+}
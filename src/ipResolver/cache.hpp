@@ -0,0 +1,79 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+
+namespace dci::module::net::ipResolver
+{
+    class Task;
+
+    //getaddrinfo results by (host, service, family), lives in the host thread only
+    class Cache
+    {
+    public:
+        struct Key
+        {
+            String  _host;
+            String  _service;
+            int     _family {};
+
+            bool operator==(const Key&) const = default;
+        };
+
+        struct Entry
+        {
+            Key                                     _key;
+            int                                     _resCode {};//not 0 - remembered failure
+            List<api::IpEndpoint>                   _endpoints;
+            std::chrono::steady_clock::time_point   _expire;
+            uint64                                  _hits {};
+        };
+
+    public:
+        void setTtl(std::chrono::milliseconds positive, std::chrono::milliseconds negative);
+        void setCapacity(uint32 capacity);
+
+        const Entry* get(const Key& key);
+        //ttl is capped by the configured one
+        void put(const Key& key, int resCode, const List<api::IpEndpoint>& endpoints, std::chrono::milliseconds ttl = std::chrono::milliseconds::max());
+        void flush();
+
+        //lookup in progress, same key requests follow it instead of a lookup of their own
+        Task* leader(const Key& key) const;
+        void lead(const Key& key, Task* task);
+        void unlead(const Key& key, Task* task);
+
+        List<api::ResolveCacheEntry> entries() const;
+        uint32 size() const;
+        uint64 hits() const;
+        uint64 misses() const;
+
+    private:
+        static bool remembered(int resCode);
+        void shrink();
+
+    private:
+        struct KeyHash
+        {
+            std::size_t operator()(const Key& key) const;
+        };
+
+        //most recently used first
+        using Lru = std::list<Entry>;
+        Lru                                                         _lru;
+        std::unordered_map<Key, Lru::iterator, KeyHash>             _index;
+        std::unordered_map<Key, Task*, KeyHash>                     _leaders;
+
+        std::chrono::milliseconds   _positiveTtl{60000};
+        std::chrono::milliseconds   _negativeTtl{5000};
+        uint32                      _capacity = 1024;
+
+        uint64                      _hits = 0;
+        uint64                      _misses = 0;
+    };
+}
@@ -0,0 +1,187 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "dns.hpp"
+
+namespace dci::module::net::ipResolver::dns
+{
+    namespace
+    {
+        constexpr std::size_t headerSize = 12;
+
+        /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+        void put16(std::string& dst, uint16 v)
+        {
+            dst.push_back(static_cast<char>(v >> 8));
+            dst.push_back(static_cast<char>(v & 0xff));
+        }
+
+        /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+        uint16 get16(const uint8* src)
+        {
+            return static_cast<uint16>((src[0] << 8) | src[1]);
+        }
+
+        /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+        uint32 get32(const uint8* src)
+        {
+            return (uint32{src[0]} << 24) | (uint32{src[1]} << 16) | (uint32{src[2]} << 8) | uint32{src[3]};
+        }
+
+        /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+        //offset past the name, 0 if malformed
+        std::size_t skipName(const uint8* data, std::size_t size, std::size_t pos)
+        {
+            while(pos < size)
+            {
+                uint8 len = data[pos];
+                if(!len)
+                {
+                    return pos + 1;
+                }
+
+                if(0xc0 == (len & 0xc0))
+                {
+                    //compression pointer ends the name in place
+                    return pos + 2 <= size ? pos + 2 : 0;
+                }
+
+                if(len & 0xc0)
+                {
+                    return 0;
+                }
+
+                pos += 1 + len;
+            }
+
+            return 0;
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::string query(uint16 id, std::string_view name, uint16 type)
+    {
+        if(!name.empty() && '.' == name.back())
+        {
+            name.remove_suffix(1);
+        }
+
+        if(name.empty() || name.size() > 253)
+        {
+            return {};
+        }
+
+        std::string res;
+        res.reserve(headerSize + name.size() + 6);
+
+        put16(res, id);
+        put16(res, 0x0100);//rd
+        put16(res, 1);//qdcount
+        put16(res, 0);
+        put16(res, 0);
+        put16(res, 0);
+
+        while(!name.empty())
+        {
+            std::size_t dot = name.find('.');
+            std::string_view label = name.substr(0, dot);
+            if(label.empty() || label.size() > 63)
+            {
+                return {};
+            }
+
+            res.push_back(static_cast<char>(label.size()));
+            res.append(label);
+
+            name.remove_prefix(std::string_view::npos == dot ? name.size() : dot + 1);
+        }
+        res.push_back(0);
+
+        put16(res, type);
+        put16(res, 1);//IN
+
+        return res;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool parse(std::string_view query, const uint8* data, std::size_t size, Response& dst)
+    {
+        if(size < query.size() || query.size() <= headerSize)
+        {
+            return false;
+        }
+
+        const uint8* q = reinterpret_cast<const uint8*>(query.data());
+
+        //same id, a response, single question equal to the asked one
+        uint16 flags = get16(data + 2);
+        if(get16(data) != get16(q) || !(flags & 0x8000) || 1 != get16(data + 4))
+        {
+            return false;
+        }
+
+        for(std::size_t i(headerSize); i<query.size(); ++i)
+        {
+            if(std::tolower(data[i]) != std::tolower(q[i]))
+            {
+                return false;
+            }
+        }
+
+        uint16 type = get16(q + query.size() - 4);
+
+        dst._rcode = static_cast<uint8>(flags & 0x0f);
+        dst._truncated = !!(flags & 0x0200);
+
+        uint16 ancount = get16(data + 6);
+        std::size_t pos = query.size();
+        for(uint16 i(0); i<ancount; ++i)
+        {
+            pos = skipName(data, size, pos);
+            if(!pos || pos + 10 > size)
+            {
+                //truncated tail, take what is parsed
+                return true;
+            }
+
+            uint16 rrType = get16(data + pos);
+            uint16 rrClass = get16(data + pos + 2);
+            uint32 ttl = get32(data + pos + 4);
+            uint16 rdLen = get16(data + pos + 8);
+            pos += 10;
+
+            if(pos + rdLen > size)
+            {
+                return true;
+            }
+
+            //cname chain is flattened by the server, only the addresses matter
+            if(1 == rrClass && rrType == type)
+            {
+                if(typeA == type && 4 == rdLen)
+                {
+                    api::Ip4Endpoint ep{};
+                    std::copy(data + pos, data + pos + 4, ep.address.octets.begin());
+                    dst._endpoints.emplace_back(ep);
+                    dst._ttl = std::min(dst._ttl, ttl);
+                }
+                else if(typeAaaa == type && 16 == rdLen)
+                {
+                    api::Ip6Endpoint ep{};
+                    std::copy(data + pos, data + pos + 16, ep.address.octets.begin());
+                    dst._endpoints.emplace_back(ep);
+                    dst._ttl = std::min(dst._ttl, ttl);
+                }
+            }
+
+            pos += rdLen;
+        }
+
+        return true;
+    }
+}
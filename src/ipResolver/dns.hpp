@@ -0,0 +1,40 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+
+//minimal rfc1035 wire format, enough for a stub resolver
+namespace dci::module::net::ipResolver::dns
+{
+    enum : uint16
+    {
+        typeA       = 1,
+        typeAaaa    = 28,
+    };
+
+    enum : uint8
+    {
+        rcodeNoError    = 0,
+        rcodeServFail   = 2,
+        rcodeNxDomain   = 3,
+    };
+
+    //empty if name is not representable
+    std::string query(uint16 id, std::string_view name, uint16 type);
+
+    struct Response
+    {
+        uint8                   _rcode {};
+        bool                    _truncated {};
+        List<api::IpEndpoint>   _endpoints;//port 0
+        uint32                  _ttl = ~uint32{};//minimal of the addresses, seconds
+    };
+
+    //false if the data is not an answer for the query
+    bool parse(std::string_view query, const uint8* data, std::size_t size, Response& dst);
+}
@@ -0,0 +1,315 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "exchange.hpp"
+#include "../utils/sockaddr.hpp"
+
+#ifndef _WIN32
+namespace dci::module::net::ipResolver
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Exchange::Exchange(const ResolvConf& conf, std::string query, std::function<void()> done)
+        : _conf(conf)
+        , _query(std::move(query))
+        , _done(std::move(done))
+    {
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Exchange::~Exchange()
+    {
+        _timer.stop();
+        closeSock();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::start()
+    {
+        _try = 0;
+        if(!startUdp(_conf._servers[0]))
+        {
+            nextTry();
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Exchange::answered() const
+    {
+        return _answered;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    const dns::Response& Exchange::response() const
+    {
+        return _response;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::nextTry()
+    {
+        if(_finished)
+        {
+            return;
+        }
+
+        //an unreachable server is skipped without waiting
+        do
+        {
+            _try++;
+            if(_try >= _conf._attempts * _conf._servers.size())
+            {
+                finish(false);
+                return;
+            }
+        }
+        while(!startUdp(_conf._servers[_try % _conf._servers.size()]));
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Exchange::startUdp(const api::IpEndpoint& server)
+    {
+        _tcp = false;
+        _server = server;
+
+        if(!open(server, SOCK_DGRAM))
+        {
+            return false;
+        }
+
+        if(0 > ::send(_sock.native(), _query.data(), _query.size(), MSG_NOSIGNAL))
+        {
+            closeSock();
+            return false;
+        }
+
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::startTcp()
+    {
+        _tcp = true;
+        _tcpOut.clear();
+        _tcpOut.push_back(static_cast<char>(_query.size() >> 8));
+        _tcpOut.push_back(static_cast<char>(_query.size() & 0xff));
+        _tcpOut.append(_query);
+        _tcpOutDone = 0;
+        _tcpIn.clear();
+
+        if(!open(_server, SOCK_STREAM))
+        {
+            nextTry();
+            return;
+        }
+
+        doWriteTcp();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Exchange::open(const api::IpEndpoint& server, int type)
+    {
+        closeSock();
+
+        _timer.stop();
+        _timer.interval(_conf._timeout);
+        _timer.start();
+
+        union
+        {
+            sockaddr            _base;
+            sockaddr_storage    _space;
+        } saddr;
+        socklen_t saddrLen = 0;
+        server.visit([&](const auto& ep){saddrLen = utils::sockaddr::convert(ep, &saddr._base);});
+
+        dci::poll::descriptor::Native native = ::socket(saddr._base.sa_family, type|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+        if(native._bad == native._value)
+        {
+            return false;
+        }
+
+        if(_sock.attach(native))
+        {
+            _sock.close();
+            return false;
+        }
+
+        _sock.ready() += _sockOwner * [this](poll::descriptor::Native, poll::descriptor::ReadyStateFlags readyState){sockReady(readyState);};
+
+        if(0 > ::connect(native, &saddr._base, saddrLen) && EINPROGRESS != errno)
+        {
+            closeSock();
+            return false;
+        }
+
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::closeSock()
+    {
+        _sockOwner.flush();
+        _sock.close();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::sockReady(poll::descriptor::ReadyStateFlags readyState)
+    {
+        if(poll::descriptor::rsf_error & readyState)
+        {
+            //icmp unreachable on udp, refused on tcp
+            closeSock();
+            nextTry();
+            return;
+        }
+
+        if(_tcp)
+        {
+            if(poll::descriptor::rsf_write & readyState)
+            {
+                doWriteTcp();
+            }
+
+            if(!_finished && _tcp && ((poll::descriptor::rsf_read|poll::descriptor::rsf_eof) & readyState))
+            {
+                doReadTcp();
+            }
+        }
+        else if(poll::descriptor::rsf_read & readyState)
+        {
+            doReadUdp();
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::doReadUdp()
+    {
+        uint8 buf[4096];
+        while(!_finished && !_tcp && _sock.valid())
+        {
+            ssize_t res = ::recv(_sock.native(), buf, sizeof(buf), MSG_TRUNC);
+            if(0 > res)
+            {
+                if(EAGAIN != errno && EWOULDBLOCK != errno)
+                {
+                    closeSock();
+                    nextTry();
+                }
+                return;
+            }
+
+            if(static_cast<std::size_t>(res) > sizeof(buf))
+            {
+                //too big for the buffer, same as truncated
+                startTcp();
+                return;
+            }
+
+            received(buf, static_cast<std::size_t>(res));
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::doWriteTcp()
+    {
+        while(_tcpOutDone < _tcpOut.size())
+        {
+            ssize_t res = ::send(_sock.native(), _tcpOut.data() + _tcpOutDone, _tcpOut.size() - _tcpOutDone, MSG_NOSIGNAL);
+            if(0 > res)
+            {
+                if(EAGAIN != errno && EWOULDBLOCK != errno && ENOTCONN != errno)
+                {
+                    closeSock();
+                    nextTry();
+                }
+                return;
+            }
+
+            _tcpOutDone += static_cast<std::size_t>(res);
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::doReadTcp()
+    {
+        char buf[4096];
+        for(;;)
+        {
+            ssize_t res = ::recv(_sock.native(), buf, sizeof(buf), 0);
+            if(0 > res)
+            {
+                if(EAGAIN != errno && EWOULDBLOCK != errno)
+                {
+                    closeSock();
+                    nextTry();
+                }
+                return;
+            }
+
+            if(!res)
+            {
+                //closed before the whole answer
+                closeSock();
+                nextTry();
+                return;
+            }
+
+            _tcpIn.append(buf, static_cast<std::size_t>(res));
+
+            if(_tcpIn.size() >= 2)
+            {
+                std::size_t size = (std::size_t{static_cast<uint8>(_tcpIn[0])} << 8) | static_cast<uint8>(_tcpIn[1]);
+                if(_tcpIn.size() >= 2 + size)
+                {
+                    received(reinterpret_cast<const uint8*>(_tcpIn.data()) + 2, size);
+                    return;
+                }
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::received(const uint8* data, std::size_t size)
+    {
+        dns::Response response;
+        if(!dns::parse(_query, data, size, response))
+        {
+            //stray or spoofed, keep waiting
+            return;
+        }
+
+        if(response._truncated && !_tcp)
+        {
+            startTcp();
+            return;
+        }
+
+        if(dns::rcodeNoError != response._rcode && dns::rcodeNxDomain != response._rcode)
+        {
+            //servfail, refused and so on, another server may know better
+            closeSock();
+            nextTry();
+            return;
+        }
+
+        _response = std::move(response);
+        finish(true);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Exchange::finish(bool answered)
+    {
+        _finished = true;
+        _answered = answered;
+        _timer.stop();
+        closeSock();
+
+        _done();
+    }
+}
+#endif
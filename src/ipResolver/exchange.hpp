@@ -0,0 +1,61 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+#include "resolvConf.hpp"
+#include "dns.hpp"
+
+namespace dci::module::net::ipResolver
+{
+    //one question to the nameservers: udp tries over servers, tcp for a truncated answer
+    class Exchange
+    {
+    public:
+        Exchange(const ResolvConf& conf, std::string query, std::function<void()> done);
+        ~Exchange();
+
+        void start();
+
+        bool answered() const;//false - no server gave an answer
+        const dns::Response& response() const;
+
+    private:
+        void nextTry();
+        bool startUdp(const api::IpEndpoint& server);
+        void startTcp();
+        bool open(const api::IpEndpoint& server, int type);
+        void closeSock();
+
+        void sockReady(poll::descriptor::ReadyStateFlags readyState);
+        void doReadUdp();
+        void doWriteTcp();
+        void doReadTcp();
+        void received(const uint8* data, std::size_t size);
+        void finish(bool answered);
+
+    private:
+        const ResolvConf &      _conf;
+        std::string             _query;
+        std::function<void()>   _done;
+
+        uint32                  _try = 0;
+        api::IpEndpoint         _server;
+        bool                    _tcp = false;
+        std::string             _tcpOut;
+        std::size_t             _tcpOutDone = 0;
+        std::string             _tcpIn;
+
+        bool                    _finished = false;
+        bool                    _answered = false;
+        dns::Response           _response;
+
+        poll::Descriptor        _sock{poll::descriptor::Native{}};
+        sbs::Owner              _sockOwner;
+        poll::Timer             _timer{std::chrono::milliseconds{}, false, [this]{nextTry();}};
+    };
+}
@@ -0,0 +1,233 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "hosts.hpp"
+#include "literal.hpp"
+#include <fstream>
+
+namespace dci::module::net::ipResolver
+{
+    namespace
+    {
+        /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+        String lowercased(std::string_view src)
+        {
+            String res{src};
+            for(char& c : res)
+            {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            return res;
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Hosts::~Hosts()
+    {
+        unwatch();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Hosts::load(const char* path)
+    {
+        //small file, whole reparse is cheaper than knowing which lines moved
+        _names.clear();
+
+        std::ifstream in{path};
+        std::string line;
+        while(std::getline(in, line))
+        {
+            std::string_view rest{line};
+            rest = rest.substr(0, rest.find('#'));
+
+            auto token = [&]
+            {
+                std::size_t begin = rest.find_first_not_of(" \t\r");
+                if(std::string_view::npos == begin)
+                {
+                    rest = {};
+                    return std::string_view{};
+                }
+                rest.remove_prefix(begin);
+
+                std::size_t end = std::min(rest.find_first_of(" \t\r"), rest.size());
+                std::string_view res = rest.substr(0, end);
+                rest.remove_prefix(end);
+                return res;
+            };
+
+            api::IpEndpoint address;
+            if(!literal::address(token(), address))
+            {
+                continue;
+            }
+
+            for(std::string_view name = token(); !name.empty(); name = token())
+            {
+                List<api::IpEndpoint>& addresses = _names[lowercased(name)];
+                if(addresses.end() == std::find(addresses.begin(), addresses.end(), address))
+                {
+                    addresses.push_back(address);
+                }
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Hosts::lookup(std::string_view name, int family, uint16 port, List<api::IpEndpoint>& dst) const
+    {
+        if(!name.empty() && '.' == name.back())
+        {
+            name.remove_suffix(1);
+        }
+
+        //usually already lowercase, no allocation then
+        bool lower = std::none_of(name.begin(), name.end(), [](char c){return c >= 'A' && c <= 'Z';});
+        auto iter = lower ? _names.find(name) : _names.find(lowercased(name));
+        if(_names.end() == iter)
+        {
+            return false;
+        }
+
+        bool found = false;
+        for(api::IpEndpoint address : iter->second)
+        {
+            bool ip4 = address.holds<api::Ip4Endpoint>();
+            if((AF_INET == family && !ip4) || (AF_INET6 == family && ip4))
+            {
+                continue;
+            }
+
+            address.visit([&](auto& ep){ep.port = port;});
+            dst.push_back(address);
+            found = true;
+        }
+
+        return found;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 Hosts::size() const
+    {
+        return static_cast<uint32>(_names.size());
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint64 Hosts::reloads() const
+    {
+        return _reloads;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Hosts::watch(const char* path)
+    {
+        unwatch();
+
+        _path = path;
+        load(_path.c_str());
+
+#ifndef _WIN32
+        dci::poll::descriptor::Native native = ::inotify_init1(IN_NONBLOCK|IN_CLOEXEC);
+        if(native._bad == native._value)
+        {
+            LOGE("hosts inotify: "<<strerror(errno));
+            return;
+        }
+
+        if(_inotify.attach(native))
+        {
+            _inotify.close();
+            return;
+        }
+        _inotify.ready() += _inotifyOwner * [this](poll::descriptor::Native, poll::descriptor::ReadyStateFlags){inotifyReady();};
+
+        //directory for replaces by rename, the file itself for in-place writes (a bind mount has no directory events)
+        std::string_view dir{_path};
+        std::size_t slash = dir.rfind('/');
+        dir = std::string_view::npos == slash ? std::string_view{"."} : slash ? dir.substr(0, slash) : std::string_view{"/"};
+        _dirWatch = ::inotify_add_watch(_inotify.native(), String{dir}.c_str(), IN_CREATE|IN_MOVED_TO|IN_CLOSE_WRITE|IN_DELETE);
+
+        watchFile();
+#endif
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Hosts::unwatch()
+    {
+#ifndef _WIN32
+        _inotifyOwner.flush();
+        _inotify.close();
+        _dirWatch = -1;
+        _fileWatch = -1;
+#endif
+    }
+
+#ifndef _WIN32
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Hosts::watchFile()
+    {
+        //same inode gives the same watch back, a replaced one gets a new;
+        //only finished writes, a replace is seen by the directory watch
+        _fileWatch = ::inotify_add_watch(_inotify.native(), _path.c_str(), IN_CLOSE_WRITE);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Hosts::inotifyReady()
+    {
+        std::string_view fileName{_path};
+        fileName.remove_prefix(std::min(fileName.size(), fileName.rfind('/') + 1));
+
+        bool changed = false;
+
+        alignas(inotify_event) char buf[4096];
+        for(;;)
+        {
+            ssize_t res = ::read(_inotify.native(), buf, sizeof(buf));
+            if(0 >= res)
+            {
+                break;
+            }
+
+            for(ssize_t pos(0); pos < res;)
+            {
+                const inotify_event* e = reinterpret_cast<const inotify_event*>(buf + pos);
+                pos += static_cast<ssize_t>(sizeof(inotify_event) + e->len);
+
+                if(e->wd == _fileWatch)
+                {
+                    if(IN_CLOSE_WRITE & e->mask)
+                    {
+                        changed = true;
+                    }
+                    if(IN_IGNORED & e->mask)
+                    {
+                        _fileWatch = -1;
+                    }
+                }
+                else if(e->wd == _dirWatch && e->len && fileName == std::string_view{e->name})
+                {
+                    changed = true;
+                }
+            }
+        }
+
+        if(changed)
+        {
+            watchFile();
+            load(_path.c_str());
+            _reloads++;
+        }
+    }
+#endif
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::size_t Hosts::NameHash::operator()(std::string_view name) const
+    {
+        return std::hash<std::string_view>{}(name);
+    }
+}
@@ -0,0 +1,55 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+
+namespace dci::module::net::ipResolver
+{
+    //parsed hosts file, names are lowercased, addresses kept in file order
+    class Hosts
+    {
+    public:
+        ~Hosts();
+
+        void load(const char* path);
+
+        //load and reload on every change: rewrite in place, replace by rename, delete and create again
+        void watch(const char* path);
+        void unwatch();
+
+        //false if the name has no address of the family
+        bool lookup(std::string_view name, int family, uint16 port, List<api::IpEndpoint>& dst) const;
+
+        uint32 size() const;
+        uint64 reloads() const;
+
+    private:
+#ifndef _WIN32
+        void watchFile();
+        void inotifyReady();
+#endif
+
+    private:
+        struct NameHash
+        {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view name) const;
+        };
+
+        std::unordered_map<String, List<api::IpEndpoint>, NameHash, std::equal_to<>>    _names;
+        uint64                                                                          _reloads = 0;
+
+        String                  _path;
+#ifndef _WIN32
+        poll::Descriptor        _inotify{poll::descriptor::Native{}};
+        sbs::Owner              _inotifyOwner;
+        int                     _dirWatch = -1;
+        int                     _fileWatch = -1;
+#endif
+    };
+}
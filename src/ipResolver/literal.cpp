@@ -0,0 +1,308 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "literal.hpp"
+
+namespace dci::module::net::ipResolver::literal
+{
+    namespace
+    {
+        /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+        bool isDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+        int hexValue(char c)
+        {
+            if(c >= '0' && c <= '9') return c - '0';
+            if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void split(std::string_view src, std::string_view& host, std::string_view& service)
+    {
+        /*
+         * ip4
+         * ip6
+         * domain.name
+         *
+         * ip4:service
+         * [ip6]:service
+         * domain.name:service
+         *
+         */
+
+        if(!src.empty() && '[' == src.front())
+        {
+            std::size_t close = src.find(']');
+            if(std::string_view::npos != close && (close + 1 == src.size() || ':' == src[close + 1]))
+            {
+                host = src.substr(1, close - 1);
+                service = close + 1 == src.size() ? std::string_view{} : src.substr(close + 2);
+                return;
+            }
+        }
+
+        std::size_t colon = src.find(':');
+        if(std::string_view::npos == colon || !colon || std::string_view::npos != src.find(':', colon + 1))
+        {
+            host = src;
+            service = {};
+            return;
+        }
+
+        host = src.substr(0, colon);
+        service = src.substr(colon + 1);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool ip4(std::string_view src, api::Ip4Address& dst)
+    {
+        for(std::size_t part(0); ; ++part)
+        {
+            uint32 v = 0;
+            std::size_t n = 0;
+            for(; n < src.size() && isDigit(src[n]); ++n)
+            {
+                //no leading zeros, as inet_pton
+                if(n && '0' == src[0])
+                {
+                    return false;
+                }
+
+                v = v * 10 + static_cast<uint32>(src[n] - '0');
+                if(v > 255)
+                {
+                    return false;
+                }
+            }
+
+            if(!n)
+            {
+                return false;
+            }
+
+            dst.octets[part] = static_cast<uint8>(v);
+            src.remove_prefix(n);
+
+            if(3 == part)
+            {
+                return src.empty();
+            }
+
+            if(src.empty() || '.' != src.front())
+            {
+                return false;
+            }
+            src.remove_prefix(1);
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool ip6(std::string_view src, api::Ip6Address& dst)
+    {
+        dst = {};
+
+        //fe80::1%eth0, fe80::1%2
+        std::size_t percent = src.find('%');
+        if(std::string_view::npos != percent)
+        {
+            std::string_view zone = src.substr(percent + 1);
+            src = src.substr(0, percent);
+
+            if(zone.empty())
+            {
+                return false;
+            }
+
+            if(std::all_of(zone.begin(), zone.end(), isDigit))
+            {
+                if(zone.size() > 9)
+                {
+                    return false;
+                }
+
+                for(char c : zone)
+                {
+                    dst.linkId = dst.linkId * 10 + static_cast<uint32>(c - '0');
+                }
+            }
+            else
+            {
+                dst.linkId = ::if_nametoindex(String{zone}.c_str());
+                if(!dst.linkId)
+                {
+                    return false;
+                }
+            }
+        }
+
+        std::array<uint16, 8> groups{};
+        std::size_t count = 0;
+        std::size_t gap = groups.size();//position of ::, none
+
+        if(src.starts_with("::"))
+        {
+            gap = 0;
+            src.remove_prefix(2);
+        }
+        else if(src.starts_with(":"))
+        {
+            return false;
+        }
+
+        while(!src.empty())
+        {
+            std::size_t n = 0;
+            uint32 v = 0;
+            for(; n < src.size() && 0 <= hexValue(src[n]); ++n)
+            {
+                v = (v << 4) | static_cast<uint32>(hexValue(src[n]));
+            }
+
+            if(n < src.size() && '.' == src[n])
+            {
+                //dotted ip4 tail takes two groups
+                api::Ip4Address tail;
+                if(count > 6 || !ip4(src, tail))
+                {
+                    return false;
+                }
+
+                groups[count++] = static_cast<uint16>((tail.octets[0] << 8) | tail.octets[1]);
+                groups[count++] = static_cast<uint16>((tail.octets[2] << 8) | tail.octets[3]);
+                break;
+            }
+
+            if(!n || n > 4 || count == groups.size())
+            {
+                return false;
+            }
+
+            groups[count++] = static_cast<uint16>(v);
+            src.remove_prefix(n);
+
+            if(src.empty())
+            {
+                break;
+            }
+
+            if(':' != src.front())
+            {
+                return false;
+            }
+            src.remove_prefix(1);
+
+            if(src.starts_with(":"))
+            {
+                if(gap != groups.size())
+                {
+                    return false;
+                }
+
+                gap = count;
+                src.remove_prefix(1);
+            }
+            else if(src.empty())
+            {
+                return false;
+            }
+        }
+
+        if(gap == groups.size() ? count != groups.size() : count == groups.size())
+        {
+            return false;
+        }
+
+        //expand the gap with zeros
+        std::size_t tail = count - std::min(gap, count);
+        std::size_t zeros = groups.size() - count;
+        for(std::size_t i(0); i<tail; ++i)
+        {
+            groups[groups.size() - 1 - i] = groups[count - 1 - i];
+        }
+
+        for(std::size_t i(0); i<zeros && gap != groups.size(); ++i)
+        {
+            groups[gap + i] = 0;
+        }
+
+        for(std::size_t i(0); i<groups.size(); ++i)
+        {
+            dst.octets[i*2] = static_cast<uint8>(groups[i] >> 8);
+            dst.octets[i*2+1] = static_cast<uint8>(groups[i] & 0xff);
+        }
+
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool address(std::string_view src, api::IpEndpoint& dst)
+    {
+        api::Ip4Endpoint ep4{};
+        if(ip4(src, ep4.address))
+        {
+            dst = ep4;
+            return true;
+        }
+
+        api::Ip6Endpoint ep6{};
+        if(ip6(src, ep6.address))
+        {
+            dst = ep6;
+            return true;
+        }
+
+        return false;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool port(std::string_view src, uint16& dst)
+    {
+        if(src.size() > 5 || !std::all_of(src.begin(), src.end(), isDigit))
+        {
+            return false;
+        }
+
+        uint32 v = 0;
+        for(char c : src)
+        {
+            v = v * 10 + static_cast<uint32>(c - '0');
+        }
+
+        if(v > 0xffff)
+        {
+            return false;
+        }
+
+        dst = static_cast<uint16>(v);
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool endpoint(std::string_view src, api::IpEndpoint& dst)
+    {
+        std::string_view host;
+        std::string_view service;
+        split(src, host, service);
+
+        uint16 p;
+        if(!port(service, p) || !address(host, dst))
+        {
+            return false;
+        }
+
+        dst.visit([&](auto& ep){ep.port = p;});
+        return true;
+    }
+}
@@ -0,0 +1,57 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+#include "../utils/makeError.hpp"
+
+//numeric endpoints without getaddrinfo
+namespace dci::module::net::ipResolver::literal
+{
+    //host:service, [ip6]:service, bare ip6 is a host as a whole
+    void split(std::string_view src, std::string_view& host, std::string_view& service);
+
+    bool ip4(std::string_view src, api::Ip4Address& dst);
+    bool ip6(std::string_view src, api::Ip6Address& dst);//with %zone
+    bool address(std::string_view src, api::IpEndpoint& dst);//port 0
+    bool port(std::string_view src, uint16& dst);//decimal only, empty is 0
+
+    //false for names and named services
+    bool endpoint(std::string_view src, api::IpEndpoint& dst);
+
+    template <class Value>
+    cmt::Future<Value> ready(const api::IpEndpoint& src);
+}
+
+namespace dci::module::net::ipResolver::literal
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    template <class Value>
+    cmt::Future<Value> ready(const api::IpEndpoint& src)
+    {
+        if constexpr(std::is_same_v<Value, api::IpEndpoint> || std::is_same_v<Value, List<api::IpEndpoint>>)
+        {
+            return cmt::readyFuture(Value{src});
+        }
+        else if constexpr(std::is_same_v<Value, api::Ip4Endpoint> || std::is_same_v<Value, List<api::Ip4Endpoint>>)
+        {
+            if(src.holds<api::Ip4Endpoint>())
+            {
+                return cmt::readyFuture(Value{src.get<api::Ip4Endpoint>()});
+            }
+        }
+        else
+        {
+            if(src.holds<api::Ip6Endpoint>())
+            {
+                return cmt::readyFuture(Value{src.get<api::Ip6Endpoint>()});
+            }
+        }
+
+        return utils::makeError<Value, api::ResolveError>("address family mismatch");
+    }
+}
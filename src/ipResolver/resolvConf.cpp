@@ -0,0 +1,87 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "resolvConf.hpp"
+#include "literal.hpp"
+#include <fstream>
+#include <sstream>
+
+namespace dci::module::net::ipResolver
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void ResolvConf::load(const char* path)
+    {
+        _servers.clear();
+        _search.clear();
+
+        std::ifstream in{path};
+        std::string line;
+        while(std::getline(in, line))
+        {
+            line = line.substr(0, line.find_first_of("#;"));
+
+            std::istringstream words{line};
+            std::string keyword;
+            if(!(words >> keyword))
+            {
+                continue;
+            }
+
+            if("nameserver" == keyword)
+            {
+                std::string value;
+                api::IpEndpoint server;
+                if(words >> value && literal::address(value, server))
+                {
+                    server.visit([](auto& ep){ep.port = 53;});
+                    _servers.push_back(server);
+                }
+            }
+            else if("search" == keyword || "domain" == keyword)
+            {
+                //the last one wins
+                _search.clear();
+                for(std::string value; words >> value;)
+                {
+                    _search.push_back(value);
+                }
+            }
+            else if("options" == keyword)
+            {
+                for(std::string value; words >> value;)
+                {
+                    auto option = [&](std::string_view name, auto& dst)
+                    {
+                        if(value.starts_with(name))
+                        {
+                            dst = static_cast<std::remove_reference_t<decltype(dst)>>(std::atoi(value.c_str() + name.size()));
+                        }
+                    };
+
+                    uint32 timeout = 0;
+                    option("ndots:", _ndots);
+                    option("timeout:", timeout);
+                    option("attempts:", _attempts);
+
+                    if(timeout)
+                    {
+                        _timeout = std::chrono::seconds{timeout};
+                    }
+                }
+            }
+        }
+
+        if(_servers.empty())
+        {
+            _servers.push_back(api::Ip4Endpoint{{127,0,0,1}, 53});
+        }
+
+        _ndots = std::min(_ndots, uint32{15});
+        _attempts = std::clamp(_attempts, uint32{1}, uint32{5});
+    }
+}
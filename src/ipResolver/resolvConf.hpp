@@ -0,0 +1,24 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+
+namespace dci::module::net::ipResolver
+{
+    //nameservers and lookup options as resolv.conf(5) has them
+    struct ResolvConf
+    {
+        List<api::IpEndpoint>       _servers;//127.0.0.1:53 if none given
+        List<String>                _search;
+        uint32                      _ndots = 1;
+        std::chrono::milliseconds   _timeout{5000};//per try
+        uint32                      _attempts = 2;//rounds over all the servers
+
+        void load(const char* path);
+    };
+}
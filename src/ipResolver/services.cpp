@@ -0,0 +1,61 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "services.hpp"
+#include "literal.hpp"
+#include <fstream>
+#include <sstream>
+
+namespace dci::module::net::ipResolver
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Services::load(const char* path)
+    {
+        _ports.clear();
+
+        std::ifstream in{path};
+        std::string line;
+        while(std::getline(in, line))
+        {
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream words{line};
+            std::string name;
+            std::string portProto;
+            if(!(words >> name >> portProto))
+            {
+                continue;
+            }
+
+            uint16 port;
+            if(!literal::port(std::string_view{portProto}.substr(0, portProto.find('/')), port))
+            {
+                continue;
+            }
+
+            _ports.emplace(name, port);
+            for(std::string alias; words >> alias;)
+            {
+                _ports.emplace(alias, port);
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Services::lookup(const String& name, uint16& port) const
+    {
+        auto iter = _ports.find(name);
+        if(_ports.end() == iter)
+        {
+            return false;
+        }
+
+        port = iter->second;
+        return true;
+    }
+}
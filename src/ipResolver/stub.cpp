@@ -0,0 +1,264 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "stub.hpp"
+#include "task.hpp"
+#include "exchange.hpp"
+#include "literal.hpp"
+
+#ifndef _WIN32
+namespace dci::module::net::ipResolver
+{
+    struct Stub::Query
+    {
+        Task*                                   _task {};
+        uint16                                  _port {};
+        List<String>                            _names;//candidates by the search list
+        std::size_t                             _name {};
+        std::vector<std::unique_ptr<Exchange>>  _exchanges;//A first
+        std::vector<std::unique_ptr<Exchange>>  _retired;
+        std::size_t                             _pending {};
+        bool                                    _noData {};
+    };
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Stub::Stub(const List<api::IpEndpoint>& nameservers, const Hosts& hosts, std::chrono::milliseconds budget)
+        : _hosts(hosts)
+    {
+        _conf.load("/etc/resolv.conf");
+        _services.load("/etc/services");
+        if(!nameservers.empty())
+        {
+            _conf._servers = nameservers;
+        }
+
+        _tryTimeout = _conf._timeout;
+        setBudget(budget);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Stub::~Stub()
+    {
+        for(Query* query : std::exchange(_queries, {}))
+        {
+            query->_exchanges.clear();
+            query->_task->complete(EAI_AGAIN, {});
+            delete query;
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Stub::setBudget(std::chrono::milliseconds budget)
+    {
+        //a silent server must not eat the whole deadline, the next ones are to be asked in time
+        std::chrono::milliseconds share = budget / (_conf._attempts * _conf._servers.size());
+        _conf._timeout = budget.count() ? std::clamp(share, std::chrono::milliseconds{1}, _tryTimeout) : _tryTimeout;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Stub::resolve(Task* task)
+    {
+        uint16 port;
+        if(!servicePort(task->service(), port))
+        {
+            task->complete(EAI_SERVICE, {});
+            return;
+        }
+
+        const String& host = task->host();
+        int family = task->family();
+
+        {
+            api::IpEndpoint numeric;
+            if(literal::address(host, numeric))
+            {
+                bool ip4 = numeric.holds<api::Ip4Endpoint>();
+                if((AF_INET == family && !ip4) || (AF_INET6 == family && ip4))
+                {
+                    task->complete(EAI_NONAME, {});
+                    return;
+                }
+
+                numeric.visit([&](auto& ep){ep.port = port;});
+                task->complete(0, {numeric});
+                return;
+            }
+        }
+
+        {
+            List<api::IpEndpoint> endpoints;
+            if(_hosts.lookup(host, family, port, endpoints))
+            {
+                task->complete(0, endpoints);
+                return;
+            }
+        }
+
+        Query* query = new Query;
+        query->_task = task;
+        query->_port = port;
+
+        //as res_search: absolute first when dotted enough, search list otherwise
+        if(!host.empty() && '.' == host.back())
+        {
+            query->_names.push_back(host);
+        }
+        else
+        {
+            bool absoluteFirst = static_cast<uint32>(std::count(host.begin(), host.end(), '.')) >= _conf._ndots;
+            if(absoluteFirst)
+            {
+                query->_names.push_back(host);
+            }
+
+            for(const String& domain : _conf._search)
+            {
+                query->_names.push_back(host + "." + domain);
+            }
+
+            if(!absoluteFirst)
+            {
+                query->_names.push_back(host);
+            }
+        }
+
+        _queries.insert(query);
+        run(query);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Stub::run(Query* query)
+    {
+        int family = query->_task->family();
+
+        std::vector<uint16> types;
+        if(AF_INET6 != family) types.push_back(dns::typeA);
+        if(AF_INET != family) types.push_back(dns::typeAaaa);
+
+        //the previous ones may be on the stack yet
+        for(std::unique_ptr<Exchange>& exchange : query->_exchanges)
+        {
+            query->_retired.push_back(std::move(exchange));
+        }
+        query->_exchanges.clear();
+
+        for(uint16 type : types)
+        {
+            std::string q = dns::query(static_cast<uint16>(_random()), query->_names[query->_name], type);
+            if(q.empty())
+            {
+                finish(query, EAI_NONAME, {});
+                return;
+            }
+
+            query->_exchanges.emplace_back(std::make_unique<Exchange>(_conf, std::move(q), [this, query]
+            {
+                if(!--query->_pending)
+                {
+                    exchanged(query);
+                }
+            }));
+        }
+
+        query->_pending = query->_exchanges.size() + 1;
+        for(std::size_t i(0); i<query->_exchanges.size(); ++i)
+        {
+            query->_exchanges[i]->start();
+        }
+
+        //all the exchanges could be done in place
+        if(!--query->_pending)
+        {
+            exchanged(query);
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Stub::exchanged(Query* query)
+    {
+        List<api::IpEndpoint> endpoints;
+        uint32 ttl = ~uint32{};
+        bool answered = true;
+        bool noData = false;
+
+        for(const std::unique_ptr<Exchange>& exchange : query->_exchanges)
+        {
+            if(!exchange->answered())
+            {
+                answered = false;
+                continue;
+            }
+
+            const dns::Response& response = exchange->response();
+            for(api::IpEndpoint ep : response._endpoints)
+            {
+                ep.visit([&](auto& ep2){ep2.port = query->_port;});
+                endpoints.push_back(ep);
+            }
+            ttl = std::min(ttl, response._ttl);
+            noData |= dns::rcodeNoError == response._rcode;
+        }
+
+        if(!endpoints.empty())
+        {
+            finish(query, 0, endpoints, std::chrono::seconds{ttl});
+            return;
+        }
+
+        if(!answered)
+        {
+            finish(query, EAI_AGAIN, {});
+            return;
+        }
+
+        query->_noData |= noData;
+        query->_name++;
+        if(query->_name < query->_names.size())
+        {
+            run(query);
+            return;
+        }
+
+#ifdef EAI_NODATA
+        finish(query, query->_noData ? EAI_NODATA : EAI_NONAME, {});
+#else
+        finish(query, EAI_NONAME, {});
+#endif
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Stub::finish(Query* query, int resCode, const List<api::IpEndpoint>& endpoints, std::chrono::milliseconds ttl)
+    {
+        _queries.erase(query);
+        query->_task->complete(resCode, endpoints, ttl);
+
+        //may be inside a callback of its own exchange
+        cmt::spawn() += [query]
+        {
+            delete query;
+        };
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Stub::servicePort(const String& service, uint16& dst) const
+    {
+        if(literal::port(service, dst))
+        {
+            return true;
+        }
+
+        if(std::all_of(service.begin(), service.end(), [](char c){return c >= '0' && c <= '9';}))
+        {
+            //numeric but out of range
+            return false;
+        }
+
+        return _services.lookup(service, dst);
+    }
+}
+#endif
@@ -0,0 +1,48 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+#include "resolvConf.hpp"
+#include "services.hpp"
+#include "hosts.hpp"
+#include <random>
+
+namespace dci::module::net::ipResolver
+{
+    class Task;
+    class Exchange;
+
+    //own dns client on the poll loop, no threads and no blocking calls
+    class Stub
+    {
+    public:
+        Stub(const List<api::IpEndpoint>& nameservers, const Hosts& hosts, std::chrono::milliseconds budget);
+        ~Stub();
+
+        //whole resolve timeout, every try gets a share of it
+        void setBudget(std::chrono::milliseconds budget);
+
+        void resolve(Task* task);
+
+    private:
+        struct Query;
+        void run(Query* query);
+        void exchanged(Query* query);
+        void finish(Query* query, int resCode, const List<api::IpEndpoint>& endpoints, std::chrono::milliseconds ttl = std::chrono::milliseconds::max());
+
+        bool servicePort(const String& service, uint16& dst) const;
+
+    private:
+        ResolvConf                  _conf;
+        std::chrono::milliseconds   _tryTimeout;//as resolv.conf has it
+        Services                    _services;
+        const Hosts &               _hosts;
+        std::unordered_set<Query*>  _queries;
+        std::mt19937                _random{std::random_device{}()};
+    };
+}
@@ -12,14 +12,15 @@
 namespace dci::module::net::ipResolver
 {
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
-    const std::regex Task::_regexHostService4{"^([^\\:]+)(?:\\:(.*))?$", std::regex::optimize};
-
-    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
-    const std::regex Task::_regexHostService6{"^\\[([^\\]]*)\\](?:\\:(.*))?$", std::regex::optimize};
+    Task::Task(std::shared_ptr<Cache> cache)
+        : _cache(std::move(cache))
+    {
+    }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     Task::~Task()
     {
+        _deadlineTimer.stop();
         _sol.flush();
         if(_res)
         {
@@ -27,12 +28,73 @@ namespace dci::module::net::ipResolver
         }
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    const String& Task::host() const
+    {
+        return _host;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    const String& Task::service() const
+    {
+        return _service;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    int Task::family() const
+    {
+        return _hint.ai_family;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Task::resolveFromCache(const Cache::Key& key)
+    {
+        const Cache::Entry* entry = _cache->get(key);
+        if(!entry)
+        {
+            return false;
+        }
+
+        resolveWith(entry->_resCode, entry->_endpoints);
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Task::joinable() const
+    {
+        //worker may skip a canceled one, nothing to follow then
+        return !_canceled.load(std::memory_order_acquire);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Task::attach(Task* follower)
+    {
+        dbgAssert(joinable());
+        _followers.push_back(follower);
+        _followed.store(true, std::memory_order_release);
+
+        //the follower deadline timer keeps running, the leader one may be later after a timeout change
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Task::expired() const
+    {
+        return std::chrono::steady_clock::now() >= _deadline;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Task::skipInThread()
+    {
+        _skipped.store(true, std::memory_order_release);
+        _awaker.wakeup();
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void Task::doWorkInThread()
     {
         dci::utils::AtScopeExit continuation{[this]{_awaker.wakeup();}};
 
-        if(_canceled.load(std::memory_order_consume))
+        if(_canceled.load(std::memory_order_consume) && !_followed.load(std::memory_order_acquire))
         {
             return;
         }
@@ -46,42 +108,67 @@ namespace dci::module::net::ipResolver
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
-    template <>
-    bool Task::fetchEndpoint<api::Ip4Endpoint>(api::Ip4Endpoint& dst, addrinfo* src)
+    Cache::Key Task::key() const
     {
-        if(!src)
-        {
-            return false;
-        }
+        return Cache::Key{_host, _service, _hint.ai_family};
+    }
 
-        if(utils::sockaddr::convert(src->ai_addr, src->ai_addrlen, dst))
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    List<api::IpEndpoint> Task::endpoints(const addrinfo* src)
+    {
+        List<api::IpEndpoint> res;
+        for(const addrinfo* ai = src; ai; ai = ai->ai_next)
         {
-            return true;
+            api::Ip4Endpoint ep4;
+            api::Ip6Endpoint ep6;
+            if(utils::sockaddr::convert(ai->ai_addr, static_cast<socklen_t>(ai->ai_addrlen), ep4))
+            {
+                res.emplace_back(ep4);
+            }
+            else if(utils::sockaddr::convert(ai->ai_addr, static_cast<socklen_t>(ai->ai_addrlen), ep6))
+            {
+                res.emplace_back(ep6);
+            }
         }
 
-        return fetchEndpoint(dst, src->ai_next);
+        return res;
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     template <>
-    bool Task::fetchEndpoint<api::Ip6Endpoint>(api::Ip6Endpoint& dst, addrinfo* src)
+    bool Task::fetchEndpoint<api::Ip4Endpoint>(api::Ip4Endpoint& dst, const List<api::IpEndpoint>& src)
     {
-        if(!src)
+        for(const api::IpEndpoint& ep : src)
         {
-            return false;
+            if(ep.holds<api::Ip4Endpoint>())
+            {
+                dst = ep.get<api::Ip4Endpoint>();
+                return true;
+            }
         }
 
-        if(utils::sockaddr::convert(src->ai_addr, src->ai_addrlen, dst))
+        return false;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    template <>
+    bool Task::fetchEndpoint<api::Ip6Endpoint>(api::Ip6Endpoint& dst, const List<api::IpEndpoint>& src)
+    {
+        for(const api::IpEndpoint& ep : src)
         {
-            return true;
+            if(ep.holds<api::Ip6Endpoint>())
+            {
+                dst = ep.get<api::Ip6Endpoint>();
+                return true;
+            }
         }
 
-        return fetchEndpoint(dst, src->ai_next);
+        return false;
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     template <>
-    bool Task::fetchEndpoint<api::IpEndpoint>(api::IpEndpoint& dst, addrinfo* src)
+    bool Task::fetchEndpoint<api::IpEndpoint>(api::IpEndpoint& dst, const List<api::IpEndpoint>& src)
     {
         {
             api::Ip4Endpoint tmp;
@@ -106,54 +193,41 @@ namespace dci::module::net::ipResolver
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     template <>
-    bool Task::fetchEndpoint<List<api::Ip4Endpoint>>(List<api::Ip4Endpoint>& dst, addrinfo* src)
+    bool Task::fetchEndpoint<List<api::Ip4Endpoint>>(List<api::Ip4Endpoint>& dst, const List<api::IpEndpoint>& src)
     {
-        if(!src)
-        {
-            return false;
-        }
-
+        for(const api::IpEndpoint& ep : src)
         {
-            api::Ip4Endpoint tmp;
-            if(utils::sockaddr::convert(src->ai_addr, src->ai_addrlen, tmp))
+            if(ep.holds<api::Ip4Endpoint>())
             {
+                const api::Ip4Endpoint& tmp = ep.get<api::Ip4Endpoint>();
                 if(dst.end() == std::find(dst.begin(), dst.end(), tmp))
                     dst.emplace_back(tmp);
-                fetchEndpoint(dst, src->ai_next);
-                return true;
             }
         }
 
-        return fetchEndpoint(dst, src->ai_next);
+        return !dst.empty();
     }
 
-
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     template <>
-    bool Task::fetchEndpoint<List<api::Ip6Endpoint>>(List<api::Ip6Endpoint>& dst, addrinfo* src)
+    bool Task::fetchEndpoint<List<api::Ip6Endpoint>>(List<api::Ip6Endpoint>& dst, const List<api::IpEndpoint>& src)
     {
-        if(!src)
+        for(const api::IpEndpoint& ep : src)
         {
-            return false;
-        }
-
-        {
-            api::Ip6Endpoint tmp;
-            if(utils::sockaddr::convert(src->ai_addr, src->ai_addrlen, tmp))
+            if(ep.holds<api::Ip6Endpoint>())
             {
+                const api::Ip6Endpoint& tmp = ep.get<api::Ip6Endpoint>();
                 if(dst.end() == std::find(dst.begin(), dst.end(), tmp))
                     dst.emplace_back(tmp);
-                fetchEndpoint(dst, src->ai_next);
-                return true;
             }
         }
 
-        return fetchEndpoint(dst, src->ai_next);
+        return !dst.empty();
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     template <>
-    bool Task::fetchEndpoint<List<api::IpEndpoint>>(List<api::IpEndpoint>& dst, addrinfo* src)
+    bool Task::fetchEndpoint<List<api::IpEndpoint>>(List<api::IpEndpoint>& dst, const List<api::IpEndpoint>& src)
     {
         List<api::Ip4Endpoint> dst4;
         List<api::Ip6Endpoint> dst6;
@@ -168,15 +242,8 @@ namespace dci::module::net::ipResolver
     }
 
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
-    void Task::resolve()
+    void Task::resolveWith(int resCode, const List<api::IpEndpoint>& endpoints)
     {
-        dci::utils::AtScopeExit continuation{[this]{delete this;}};
-
-        if(_canceled.load(std::memory_order_consume))
-        {
-            return;
-        }
-
         std::visit([&](auto& p)
         {
             if constexpr(std::is_same_v<char&, decltype(p)>)
@@ -190,14 +257,14 @@ namespace dci::module::net::ipResolver
                     return;
                 }
 
-                if(_resCode)
+                if(resCode)
                 {
-                    p.resolveException(utils::makeError<api::ResolveError>(gai_strerror(_resCode)));
+                    p.resolveException(utils::makeError<api::ResolveError>(gai_strerror(resCode)));
                     return;
                 }
 
                 typename std::remove_reference_t<decltype(p)>::Value v {};
-                if(fetchEndpoint(v, _res))
+                if(fetchEndpoint(v, endpoints))
                 {
                     p.resolveValue(std::move(v));
                 }
@@ -208,4 +275,81 @@ namespace dci::module::net::ipResolver
             }
         }, _promiseVar);
     }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Task::settle(int resCode, const List<api::IpEndpoint>& endpoints)
+    {
+        if(!_canceled.load(std::memory_order_consume))
+        {
+            resolveWith(resCode, endpoints);
+        }
+
+        for(Task* follower : std::exchange(_followers, {}))
+        {
+            if(!follower->_canceled.load(std::memory_order_consume))
+            {
+                follower->resolveWith(resCode, endpoints);
+            }
+            delete follower;
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Task::deadline()
+    {
+        //a running lookup is not interrupted, its late result is dropped in resolve
+        std::visit([&](auto& p)
+        {
+            if constexpr(!std::is_same_v<char&, decltype(p)>)
+            {
+                if(!p.resolved())
+                {
+                    p.resolveException(utils::makeError<api::TimedOut>("resolve deadline exceeded"));
+                }
+            }
+        }, _promiseVar);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Task::resolve()
+    {
+        dci::utils::AtScopeExit continuation{[this]{delete this;}};
+
+        _cache->unlead(key(), this);
+
+        if(_skipped.load(std::memory_order_acquire))
+        {
+            //followers came later but share the queue wait
+            if(!_canceled.load(std::memory_order_consume))
+            {
+                deadline();
+            }
+
+            for(Task* follower : std::exchange(_followers, {}))
+            {
+                follower->deadline();
+                delete follower;
+            }
+            return;
+        }
+
+        //the cache serves any flavor of request from the whole list
+        List<api::IpEndpoint> all = endpoints(_resCode ? nullptr : _res);
+
+        if(_res || _resCode)//was executed
+        {
+            _cache->put(key(), _resCode, all);
+        }
+        settle(_resCode, all);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Task::complete(int resCode, const List<api::IpEndpoint>& endpoints, std::chrono::milliseconds ttl)
+    {
+        dci::utils::AtScopeExit continuation{[this]{delete this;}};
+
+        _cache->unlead(key(), this);
+        _cache->put(key(), resCode, endpoints, ttl);
+        settle(resCode, endpoints);
+    }
 }
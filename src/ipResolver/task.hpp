@@ -8,29 +8,60 @@
 #pragma once
 #include "pch.hpp"
 #include "../utils/sockaddr.hpp"
-#include <regex>
+#include "cache.hpp"
+#include "literal.hpp"
 
 namespace dci::module::net::ipResolver
 {
     class Task
     {
     public:
+        Task(std::shared_ptr<Cache> cache);
         ~Task();
 
         template <class Value>
-        cmt::Future<Value> init(auto&& src);
+        static constexpr int familyOf();
 
+        template <class Value>
+        cmt::Future<Value> init(auto&& src, std::chrono::milliseconds timeout);
+
+        const String& host() const;
+        const String& service() const;
+        int family() const;
+
+        Cache::Key key() const;
+        bool resolveFromCache(const Cache::Key& key);
+
+        //same lookup, the follower gets the leader result
+        bool joinable() const;
+        void attach(Task* follower);
+
+        bool expired() const;
         void doWorkInThread();
+        void skipInThread();
         void resolve();
 
-    private:
+        //result from elsewhere than the worker, the task is deleted
+        void complete(int resCode, const List<api::IpEndpoint>& endpoints, std::chrono::milliseconds ttl = std::chrono::milliseconds::max());
+
+        //all the addresses in getaddrinfo order, any value flavor is fetched from them
+        static List<api::IpEndpoint> endpoints(const addrinfo* src);
+
         template <class Dst>
-        bool fetchEndpoint(Dst& dst, addrinfo* src);
+        static bool fetchEndpoint(Dst& dst, const List<api::IpEndpoint>& src);
+
+    private:
+
+        void resolveWith(int resCode, const List<api::IpEndpoint>& endpoints);
+        void settle(int resCode, const List<api::IpEndpoint>& endpoints);
+        void deadline();
 
     public:
         Task*       _next4Worker {};
 
     private:
+        std::shared_ptr<Cache>  _cache;
+
         String      _host;
         String      _service;
 
@@ -50,65 +81,61 @@ namespace dci::module::net::ipResolver
         >;
         PromiseVar          _promiseVar;
         std::atomic<bool>   _canceled = false;
+        std::atomic<bool>   _skipped = false;
+
+        std::vector<Task*>  _followers;
+        std::atomic<bool>   _followed = false;//a canceled leader still works for them
+
+        std::chrono::steady_clock::time_point   _deadline = std::chrono::steady_clock::time_point::max();
+        poll::Timer                             _deadlineTimer{std::chrono::milliseconds{}, false, [this]{deadline();}};
 
         poll::Awaker        _awaker;
         sbs::Owner          _sol;
-
-    private:
-        static const std::regex _regexHostService4;
-        static const std::regex _regexHostService6;
     };
 
+    template <> bool Task::fetchEndpoint<api::Ip4Endpoint>(api::Ip4Endpoint& dst, const List<api::IpEndpoint>& src);
+    template <> bool Task::fetchEndpoint<api::Ip6Endpoint>(api::Ip6Endpoint& dst, const List<api::IpEndpoint>& src);
+    template <> bool Task::fetchEndpoint<api::IpEndpoint>(api::IpEndpoint& dst, const List<api::IpEndpoint>& src);
+    template <> bool Task::fetchEndpoint<List<api::Ip4Endpoint>>(List<api::Ip4Endpoint>& dst, const List<api::IpEndpoint>& src);
+    template <> bool Task::fetchEndpoint<List<api::Ip6Endpoint>>(List<api::Ip6Endpoint>& dst, const List<api::IpEndpoint>& src);
+    template <> bool Task::fetchEndpoint<List<api::IpEndpoint>>(List<api::IpEndpoint>& dst, const List<api::IpEndpoint>& src);
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     template <class Value>
-    cmt::Future<Value> Task::init(auto&& src)
+    constexpr int Task::familyOf()
     {
-        /*
-         * ip4
-         * ip6
-         * domain.name
-         *
-         * ip4:service
-         * [ip6]:service
-         * domain.name:service
-         *
-         */
-
-        {
-            std::smatch match;
-            if(std::regex_match(src, match, _regexHostService6))
-            {
-                _host = match[1];
-                _service = match[2];
-            }
-            else if(std::regex_match(src, match, _regexHostService4))
-            {
-                _host = match[1];
-                _service = match[2];
-            }
-            else
-            {
-                _host = std::forward<decltype(src)>(src);
-            }
-        }
-
-
-        memset(&_hint, 0, sizeof(_hint));
-        _hint.ai_flags = AI_ALL | AI_ADDRCONFIG;
-
         if constexpr(std::is_same_v<Value, api::Ip4Endpoint> || std::is_same_v<Value, List<api::Ip4Endpoint>>)
         {
-            _hint.ai_family = AF_INET;
+            return AF_INET;
         }
         else if constexpr(std::is_same_v<Value, api::Ip6Endpoint> || std::is_same_v<Value, List<api::Ip6Endpoint>>)
         {
-            _hint.ai_family = AF_INET6;
+            return AF_INET6;
         }
         else
         {
-            _hint.ai_family = AF_UNSPEC;
+            return AF_UNSPEC;
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    template <class Value>
+    cmt::Future<Value> Task::init(auto&& src, std::chrono::milliseconds timeout)
+    {
+        {
+            std::string_view host;
+            std::string_view service;
+            literal::split(src, host, service);
+
+            _host = host;
+            _service = service;
         }
 
+        memset(&_hint, 0, sizeof(_hint));
+        _hint.ai_flags = AI_ALL | AI_ADDRCONFIG;
+
+        _hint.ai_family = familyOf<Value>();
+
         using Promise = cmt::Promise<Value>;
         Promise p;
         p.canceled() += _sol * [this]
@@ -124,6 +151,13 @@ namespace dci::module::net::ipResolver
             resolve();
         };
 
+        if(timeout.count())
+        {
+            _deadline = std::chrono::steady_clock::now() + timeout;
+            _deadlineTimer.interval(timeout);
+            _deadlineTimer.start();
+        }
+
         return f;
     }
 }
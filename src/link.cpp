@@ -211,6 +211,18 @@ namespace dci::module::net
         }
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 Link::mtu() const
+    {
+        return _mtu;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    api::link::Flags Link::flags() const
+    {
+        return _flags;
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void Link::flushChanges()
     {
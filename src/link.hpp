@@ -32,6 +32,9 @@ namespace dci::module::net
         void addIp6(api::link::Ip6Address address);
         void delIp6(api::link::Ip6Address address);
 
+        uint32 mtu() const;
+        api::link::Flags flags() const;
+
         void flushChanges();
         void remove();
 
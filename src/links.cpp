@@ -103,8 +103,14 @@ namespace dci::module::net
             _interfaces[p.first] = *link;
         }
 
+        _maxMtu = 0;
         for(auto& p : _implementations)
         {
+            if(api::link::Flags{} == (p.second->flags() & api::link::Flags::loopback))
+            {
+                _maxMtu = std::max(_maxMtu, p.second->mtu());
+            }
+
             p.second->flushChanges();
         }
 
@@ -113,4 +119,10 @@ namespace dci::module::net
             (*_iface)->linkAdded(p.first, _interfaces[p.first]);
         }
     }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 Links::maxMtu() const
+    {
+        return _maxMtu;
+    }
 }
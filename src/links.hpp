@@ -29,6 +29,9 @@ namespace dci::module::net
 
         void flushChanges();
 
+        //max mtu over non-loopback links, 0 if unknown
+        uint32 maxMtu() const;
+
     private:
         using Interfaces        = Map<uint32, api::Link<>>;
         using Implementations   = Map<uint32, std::unique_ptr<Link>>;
@@ -44,5 +47,7 @@ namespace dci::module::net
         //changes
         Implementations     _added;
         Ids                 _deleted;
+
+        uint32              _maxMtu = 0;
     };
 }
@@ -142,6 +142,94 @@ namespace dci::module::net
                 }
                 return ExceptionPtr();
             },
+            [&](const api::option::ReceiveCoalescing& op)
+            {
+#ifdef _WIN32
+                (void)op;
+                return std::make_exception_ptr(api::OperationNotSupported{"receive coalescing is not supported"});
+#else
+                int v = op.enable ? 1 : 0;
+                if(::setsockopt(native, SOL_UDP, UDP_GRO, setsockopt_cast(&v), sizeof(v))) return utils::fetchSystemError();
+                return ExceptionPtr();
+#endif
+            },
+            [&](const api::option::ReceiveTimestamp& op)
+            {
+#ifdef _WIN32
+                (void)op;
+                return std::make_exception_ptr(api::OperationNotSupported{"receive timestamp is not supported"});
+#else
+                int v = op.enable ? 1 : 0;
+                if(::setsockopt(native, SOL_SOCKET, SO_TIMESTAMPNS, setsockopt_cast(&v), sizeof(v))) return utils::fetchSystemError();
+                return ExceptionPtr();
+#endif
+            },
+            [&](const api::option::MaxPacingRate& op)
+            {
+#ifdef _WIN32
+                (void)op;
+                return std::make_exception_ptr(api::OperationNotSupported{"pacing rate is not supported"});
+#else
+                uint64 v = op.bytesPerSecond ? op.bytesPerSecond : ~uint64{};
+                if(::setsockopt(native, SOL_SOCKET, SO_MAX_PACING_RATE, setsockopt_cast(&v), sizeof(v))) return utils::fetchSystemError();
+                return ExceptionPtr();
+#endif
+            },
+            [&](const api::option::TxTime& op)
+            {
+#ifdef _WIN32
+                (void)op;
+                return std::make_exception_ptr(api::OperationNotSupported{"tx time is not supported"});
+#else
+                //there is no way to switch it off, without SCM_TXTIME datagrams are sent as usual
+                if(op.enable)
+                {
+                    sock_txtime v{};
+                    v.clockid = CLOCK_MONOTONIC;
+                    if(::setsockopt(native, SOL_SOCKET, SO_TXTIME, setsockopt_cast(&v), sizeof(v))) return utils::fetchSystemError();
+                }
+                return ExceptionPtr();
+#endif
+            },
+            [&](const api::option::PacketInfo& op)
+            {
+#ifdef _WIN32
+                (void)op;
+                return std::make_exception_ptr(api::OperationNotSupported{"packet info is not supported"});
+#else
+                int domain = AF_UNSPEC;
+                socklen_t domainLen = sizeof(domain);
+                if(::getsockopt(native, SOL_SOCKET, SO_DOMAIN, &domain, &domainLen)) return utils::fetchSystemError();
+
+                int v = op.enable ? 1 : 0;
+                if(AF_INET6 == domain)
+                {
+                    if(::setsockopt(native, IPPROTO_IPV6, IPV6_RECVPKTINFO, setsockopt_cast(&v), sizeof(v))) return utils::fetchSystemError();
+                }
+                else
+                {
+                    if(::setsockopt(native, IPPROTO_IP, IP_PKTINFO, setsockopt_cast(&v), sizeof(v))) return utils::fetchSystemError();
+                }
+                return ExceptionPtr();
+#endif
+            },
+            [&](const api::option::SharedRing& op)
+            {
+#ifdef _WIN32
+                (void)op;
+                return std::make_exception_ptr(api::OperationNotSupported{"shared ring is not supported"});
+#else
+                //not a socket option, used by the client and the server at the handshake
+                (void)op;
+                return ExceptionPtr();
+#endif
+            },
+            [&](const api::option::InProcess& op)
+            {
+                //not a socket option, used by the host at connect
+                (void)op;
+                return ExceptionPtr();
+            },
             [&](const auto& op)
             {
                 (void)op;
@@ -8,6 +8,7 @@
 #pragma once
 #include <dci/mm/heap/allocable.hpp>
 #include <dci/sbs.hpp>
+#include <dci/cmt.hpp>
 #include <dci/poll.hpp>
 #include <dci/logger.hpp>
 #include <dci/host/module/entry.hpp>
@@ -26,6 +27,16 @@
 #include <condition_variable>
 #include <atomic>
 #include <codecvt>
+#include <deque>
+#include <list>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
+#include <bit>
 
 #include <unistd.h>
 
@@ -61,9 +72,35 @@
 #   include <sys/socket.h>
 #   include <sys/uio.h>
 #   include <netdb.h>
+#   include <arpa/inet.h>
+#   include <signal.h>
+#   include <sys/inotify.h>
 #   include <netinet/tcp.h>
+#   include <netinet/udp.h>
+
+#   ifndef UDP_SEGMENT
+#       define UDP_SEGMENT 103
+#   endif
+
+#   ifndef UDP_GRO
+#       define UDP_GRO 104
+#   endif
+
+#   include <linux/net_tstamp.h>
+
+#   ifndef SO_TXTIME
+#       define SO_TXTIME 61
+#       define SCM_TXTIME SO_TXTIME
+#   endif
+
+#   ifndef SO_MAX_PACING_RATE
+#       define SO_MAX_PACING_RATE 47
+#   endif
 
 #   include <sys/eventfd.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
 
 struct Buf : iovec
 {
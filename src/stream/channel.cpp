@@ -10,19 +10,24 @@
 #include "../host.hpp"
 #include "../utils/sockaddr.hpp"
 #include "../utils/makeError.hpp"
+#include "../utils/ancillary.hpp"
 #include "dci/poll/descriptor/native.hpp"
 
 namespace dci::module::net::stream
 {
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
-    Channel::Channel(Host* host, poll::descriptor::Native sock, const api::Endpoint& localEndpoint, api::Endpoint&& remoteEndpoint)
+    Channel::Channel(Host* host, poll::descriptor::Native sock, const api::Endpoint& localEndpoint, api::Endpoint&& remoteEndpoint, bool seqpacket)
         : api::stream::Channel<>::Opposite(idl::interface::Initializer())
         , _host{host}
         , _sock{sock}
         , _localEndpoint{localEndpoint}
         , _remoteEndpoint{std::move(remoteEndpoint)}
+        , _seqpacket{seqpacket}
         , _connectPromise{cmt::PromiseNullInitializer{}}
         , _connected{_sock.valid()}
+#ifndef _WIN32
+        , _ringWake{poll::descriptor::Native{}}
+#endif
     {
         if(_connected)
         {
@@ -66,13 +71,56 @@ namespace dci::module::net::stream
                 return;
             }
 
-            _sendBuffer.push(std::forward<decltype(bytes)>(bytes));
+            if(_seqpacket)
+            {
+                pushMessage(Bytes{std::forward<decltype(bytes)>(bytes)});
+            }
+            else
+            {
+                _sendBuffer.push(std::forward<decltype(bytes)>(bytes));
+            }
+
             if(poll::descriptor::rsf_write & _lastReadyState)
             {
                 _sock.emitReady();
             }
         };
 
+        methods()->sendv() += this * [&](auto&& bytesList)
+        {
+            if(!_connected)
+            {
+                failed(utils::makeError<api::NotConnected>());
+                return;
+            }
+
+            if(_seqpacket)
+            {
+                for(auto&& bytes : bytesList)
+                {
+                    pushMessage(Bytes{std::move(bytes)});
+                }
+            }
+            else
+            {
+                _sendBuffer.push(std::forward<decltype(bytesList)>(bytesList));
+            }
+
+            if(poll::descriptor::rsf_write & _lastReadyState)
+            {
+                _sock.emitReady();
+            }
+        };
+
+        methods()->sharedRingReceived() += this * [&]()
+        {
+#ifndef _WIN32
+            return cmt::readyFuture(_ringReceived);
+#else
+            return cmt::readyFuture(uint64{});
+#endif
+        };
+
         methods()->setReceiveGranula() += this * [&](uint64 granula)
         {
             setReceiveGranula(granula);
@@ -88,6 +136,11 @@ namespace dci::module::net::stream
             setReceiveGranula(0);
         };
 
+        methods()->receiveExact() += this * [&](uint64 size)
+        {
+            return receiveExact(size);
+        };
+
         methods()->shutdown() += this * [&](bool input, bool output)
         {
             shutdown(input, output);
@@ -105,6 +158,9 @@ namespace dci::module::net::stream
         sbs::Owner::flush();
         _sockReadyOwner.flush();
         _sock.close();
+#ifndef _WIN32
+        stopRing();
+#endif
         _host->untrack(this);
     }
 
@@ -118,7 +174,7 @@ namespace dci::module::net::stream
 #ifdef _WIN32
         dci::poll::descriptor::Native native = ::WSASocketW(utils::sockaddr::family(_remoteEndpoint), SOCK_STREAM, PF_UNSPEC, nullptr, 0, WSA_FLAG_NO_HANDLE_INHERIT);
 #else
-        dci::poll::descriptor::Native native = ::socket(utils::sockaddr::family(_remoteEndpoint), SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+        dci::poll::descriptor::Native native = ::socket(utils::sockaddr::family(_remoteEndpoint), (_seqpacket ? SOCK_SEQPACKET : SOCK_STREAM)|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
 #endif
 
         if(native._bad == native._value)
@@ -132,6 +188,19 @@ namespace dci::module::net::stream
             return utils::makeError<api::stream::Channel<>>(ec);
         }
 
+#ifndef _WIN32
+        if(!_seqpacket && _remoteEndpoint.holds<api::LocalEndpoint>())
+        {
+            for(const api::Option& op : options())
+            {
+                if(op.holds<api::option::SharedRing>())
+                {
+                    _ringSize = op.get<api::option::SharedRing>().size;
+                }
+            }
+        }
+#endif
+
         ExceptionPtr e = applyOptions(_sock);
         if(e)
         {
@@ -167,6 +236,9 @@ namespace dci::module::net::stream
             _connected = true;
             _sockReadyOwner.flush();
             _sock.ready() += _sockReadyOwner * [this](poll::descriptor::Native native, poll::descriptor::ReadyStateFlags readyState){connectedSockReady(native, readyState);};
+#ifndef _WIN32
+            offerRing(native);
+#endif
             return cmt::readyFuture(api::stream::Channel<>(*this));
         }
 
@@ -194,6 +266,15 @@ namespace dci::module::net::stream
         return _connectPromise.future();
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::awaitRing()
+    {
+#ifndef _WIN32
+        dbgAssert(_connected && !_seqpacket);
+        _ringPending = true;
+#endif
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void Channel::setReceiveGranula(uint64 granula)
     {
@@ -212,6 +293,135 @@ namespace dci::module::net::stream
         }
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    cmt::Future<Bytes> Channel::receiveExact(uint64 size)
+    {
+        if(!_connected)
+        {
+            return cmt::readyFuture<Bytes>(utils::makeError<api::NotConnected>());
+        }
+
+        if(_seqpacket)
+        {
+            return cmt::readyFuture<Bytes>(utils::makeError<api::OperationNotSupported>("exact receive does not fit message boundaries"));
+        }
+
+        if(size > std::numeric_limits<uint32>::max())
+        {
+            return cmt::readyFuture<Bytes>(utils::makeError<api::InvalidArgument>());
+        }
+
+        if(!size)
+        {
+            return cmt::readyFuture(Bytes{});
+        }
+
+        bool wasEmpty = _exactRequests.empty();
+        _exactRequests.emplace_back(ExactRequest{static_cast<uint32>(size), {}});
+        cmt::Future<Bytes> res = _exactRequests.back()._promise.future();
+
+        if(wasEmpty)
+        {
+            updateReceiveLowat();
+
+            if(!_receiveGranula && (poll::descriptor::rsf_read & _lastReadyState))
+            {
+                _sock.emitReady();
+            }
+        }
+
+        return res;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 Channel::exactRemaining() const
+    {
+        dbgAssert(!_exactRequests.empty());
+        dbgAssert(_exactRequests.front()._size > _exactAccumulator.size());
+
+        return _exactRequests.front()._size - _exactAccumulator.size();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::exactReceived(Bytes&& data)
+    {
+        dbgAssert(!_exactRequests.empty());
+
+        _exactAccumulator.end().write(std::move(data));
+        if(_exactAccumulator.size() < _exactRequests.front()._size)
+        {
+            return;
+        }
+
+        dbgAssert(_exactAccumulator.size() == _exactRequests.front()._size);
+        cmt::Promise<Bytes> promise = std::move(_exactRequests.front()._promise);
+        _exactRequests.pop_front();
+
+        if(promise.resolved())
+        {
+            //requester gone, the data is not lost but goes to the regular flow
+            methods()->received(std::move(_exactAccumulator));
+        }
+        else
+        {
+            promise.resolveValue(std::move(_exactAccumulator));
+        }
+        _exactAccumulator.clear();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::exactFailed(ExceptionPtr e)
+    {
+        std::deque<ExactRequest> exactRequests;
+        exactRequests.swap(_exactRequests);
+        _exactAccumulator.clear();
+
+        for(ExactRequest& r : exactRequests)
+        {
+            if(!r._promise.resolved())
+            {
+                r._promise.resolveException(e);
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::updateReceiveLowat()
+    {
+#ifndef _WIN32
+        if(!_sock.valid())
+        {
+            return;
+        }
+
+        //wake up only when the whole rest of an exact request is here, but never above the rest itself
+        constexpr uint32 lowatMax = 64*1024;
+        uint32 lowat = _exactRequests.empty() ? 1 : std::min(exactRemaining(), lowatMax);
+
+        if(lowat != _receiveLowat)
+        {
+            int v = static_cast<int>(lowat);
+            if(!::setsockopt(_sock.native(), SOL_SOCKET, SO_RCVLOWAT, &v, sizeof(v)))
+            {
+                _receiveLowat = lowat;
+            }
+        }
+#endif
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::pushMessage(Bytes&& data)
+    {
+        //zero-length message is indistinguishable from the peer shutdown
+        if(data.empty())
+        {
+            return;
+        }
+
+        _messagesSize += static_cast<uint32>(data.size());
+        _messages.emplace_back(std::move(data));
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void Channel::failed(ExceptionPtr e, bool doClose)
     {
@@ -238,6 +448,12 @@ namespace dci::module::net::stream
             }
 
             _sendBuffer.clear();
+            _messages.clear();
+            _messagesSize = 0;
+#ifndef _WIN32
+            stopRing();
+#endif
+            exactFailed(e);
         }
 
         si->failed(e);
@@ -296,6 +512,12 @@ namespace dci::module::net::stream
 
         _lastReadyState = poll::descriptor::rsf_close;
         _sendBuffer.clear();
+        _messages.clear();
+        _messagesSize = 0;
+#ifndef _WIN32
+        stopRing();
+#endif
+        exactFailed(exception::buildInstance<api::ConnectionClosed>());
 
         if(_connected)
         {
@@ -310,6 +532,33 @@ namespace dci::module::net::stream
         dbgAssert(_sock.native() == native);
         dbgAssert(_lastReadyState & poll::descriptor::rsf_write);
 
+#ifndef _WIN32
+        if(_seqpacket)
+        {
+            return doWriteMessages(native, preCloseMode);
+        }
+
+        if(_ringPending && !_sendBuffer.empty())
+        {
+            //the ack has to be the first bytes back, so the mode is decided before own data goes out
+            acceptRing(native, true);
+            if(_ringPending)
+            {
+                return false;
+            }
+        }
+
+        if(_ring && !_ringOffered)
+        {
+            if(_ringAckSend && !sendRingAck(native))
+            {
+                return false;
+            }
+
+            return doWriteRing(preCloseMode);
+        }
+#endif
+
         if(_sendBuffer.empty())
         {
             return false;
@@ -391,11 +640,29 @@ namespace dci::module::net::stream
         dbgAssert(_sock.native() == native);
         dbgAssert(_lastReadyState & poll::descriptor::rsf_read);
 
+#ifndef _WIN32
+        if(_seqpacket)
+        {
+            return doReadMessages(native);
+        }
+
+        if(_ringPending || _ringDecline)
+        {
+            //held until the first bytes of the peer tell the mode
+            return false;
+        }
+
+        if(_ring && !_ringAckWait)
+        {
+            return doReadRing();
+        }
+#endif
+
         utils::RecvBuffer* recvBuffer = _host->getRecvBuffer();
         uint32 totalReaded = 0;
-        while((poll::descriptor::rsf_read & _lastReadyState) && _receiveGranula)
+        while((poll::descriptor::rsf_read & _lastReadyState) && (_receiveGranula || !_exactRequests.empty()))
         {
-            recvBuffer->limitDataSize(_receiveGranula);
+            recvBuffer->limitDataSize(_exactRequests.empty() ? _receiveGranula : exactRemaining());
 
 #ifdef _WIN32
             DWORD received{};
@@ -406,7 +673,10 @@ namespace dci::module::net::stream
                 res = received;
             }
 #else
-            ssize_t res = ::readv(native, recvBuffer->bufs(), static_cast<int>(recvBuffer->bufsAmount()));
+            //recvmsg instead of readv for the ancillary data, SO_TIMESTAMPNS may be inherited from a listener
+            alignas(cmsghdr) char control[64];
+            msghdr msg{nullptr, 0, recvBuffer->bufs(), recvBuffer->bufsAmount(), control, sizeof(control), 0};
+            ssize_t res = ::recvmsg(native, &msg, 0);
 #endif
 
             recvBuffer->unlimitDataSize();
@@ -443,12 +713,585 @@ namespace dci::module::net::stream
 
             uint32 readed = static_cast<uint32>(res);
             totalReaded += readed;
-            methods()->received(recvBuffer->detach(readed));
+
+#ifndef _WIN32
+            utils::ancillary::Values ancillary = utils::ancillary::parse(msg);
+            bool ringAck = false;
+            if(0 <= ancillary._fd)
+            {
+                //descriptors have no place in the byte stream, except the shared ring ack,
+                //the kernel ends the read on it, so the last byte is the ack itself
+                ::close(ancillary._fd);
+                ringAck = _ringAckWait;
+            }
+
+            if(ringAck)
+            {
+                readed--;
+                _ringAckWait = false;
+                _lastReadyState |= poll::descriptor::rsf_read;
+
+                if(_ringOffered)
+                {
+                    //accepted, own writes follow with the own ack
+                    _ringOffered = false;
+                    _ringAckSend = true;
+                    _lastReadyState |= poll::descriptor::rsf_write;
+                }
+            }
+            else if(_ringOffered)
+            {
+                //the first bytes back are not the ack, the peer is plain or declined, everything stays on the socket
+                stopRing();
+            }
+
+            if(ancillary._timestamp)
+            {
+                methods()->timestamp(ancillary._timestamp);
+            }
+
+            if(!readed)
+            {
+                break;
+            }
+#endif
+
+            if(_exactRequests.empty())
+            {
+                methods()->received(recvBuffer->detach(readed));
+            }
+            else
+            {
+                exactReceived(recvBuffer->detach(readed));
+            }
+
+#ifndef _WIN32
+            if(ringAck)
+            {
+                //the rest goes through the ring
+                break;
+            }
+#endif
+        }
+
+        if(totalReaded)
+        {
+            updateReceiveLowat();
         }
 
         return 0 < totalReaded;
     }
 
+#ifndef _WIN32
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::doWriteMessages(poll::descriptor::Native native, bool preCloseMode)
+    {
+        datagram::SendBuffer* sendBuffer = _host->getDatagramSendBuffer();
+        uint32 totalWrote = 0;
+
+        while((poll::descriptor::rsf_write & _lastReadyState) && !_messages.empty())
+        {
+            //connected socket, messages go without address
+            sendBuffer->clear();
+            for(const Bytes& message : _messages)
+            {
+                if(!sendBuffer->push(message, api::Endpoint{}))
+                {
+                    break;
+                }
+            }
+
+            int res;
+            uint32 requested;
+
+            if(!sendBuffer->msgsAmount())
+            {
+                //more chunks than iovecs, goes alone from a flat copy
+                requested = 1;
+                res = sendFlat(native, _messages.front());
+            }
+            else
+            {
+                requested = sendBuffer->msgsAmount();
+                res = ::sendmmsg(native, sendBuffer->msgs(), requested, MSG_NOSIGNAL);
+                sendBuffer->clear();
+            }
+
+            if(0 > res)
+            {
+                _lastReadyState &= ~poll::descriptor::rsf_write;
+
+                if(EAGAIN != errno)
+                {
+                    if(preCloseMode)
+                    {
+                        _messages.clear();
+                        _messagesSize = 0;
+                    }
+                    else
+                    {
+                        failed(utils::fetchSystemError(), true);
+                    }
+                    return false;
+                }
+
+                break;
+            }
+
+            for(int i(0); i<res; ++i)
+            {
+                uint32 wrote = static_cast<uint32>(_messages.front().size());
+                totalWrote += wrote;
+                _messagesSize -= wrote;
+                _messages.pop_front();
+            }
+
+            if(static_cast<uint32>(res) < requested)
+            {
+                _lastReadyState &= ~poll::descriptor::rsf_write;
+                break;
+            }
+        }
+
+        if(!preCloseMode && totalWrote)
+        {
+            methods()->sended(totalWrote, _messagesSize);
+        }
+
+        return 0 < totalWrote;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    int Channel::sendFlat(poll::descriptor::Native native, const Bytes& data)
+    {
+        std::size_t size = data.size();
+        std::unique_ptr<byte[]> flat{new byte[size]};
+
+        byte* dst = flat.get();
+        for(bytes::Cursor src = data.begin(); !src.atEnd(); src.advanceChunks(1))
+        {
+            memcpy(dst, src.continuousData(), src.continuousDataSize());
+            dst += src.continuousDataSize();
+        }
+
+        iovec iov{flat.get(), size};
+        msghdr msg{nullptr, 0, &iov, 1, nullptr, 0, 0};
+
+        if(0 > ::sendmsg(native, &msg, MSG_NOSIGNAL))
+        {
+            return -1;
+        }
+
+        return 1;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::doReadMessages(poll::descriptor::Native native)
+    {
+        //every slot takes the largest message the peer can send, the whole batch goes in one call
+        datagram::RecvBuffer* recvBuffer = _host->getLocalRecvBuffer();
+        uint32 totalReaded = 0;
+
+        while((poll::descriptor::rsf_read & _lastReadyState) && _receiveGranula)
+        {
+            recvBuffer->prepare();
+
+            uint32 requested = recvBuffer->msgsAmount();
+            int res = ::recvmmsg(native, recvBuffer->msgs(), requested, 0, nullptr);
+
+            if(0 > res)
+            {
+                _lastReadyState &= ~poll::descriptor::rsf_read;
+
+                if(EAGAIN == errno)
+                {
+                    break;
+                }
+
+                if(!(_lastReadyState & poll::descriptor::rsf_eof))
+                {
+                    failed(utils::fetchSystemError(), true);
+                }
+                return false;
+            }
+
+            for(uint32 i(0); i<static_cast<uint32>(res); ++i)
+            {
+                mmsghdr& msg = recvBuffer->msgs()[i];
+
+                if(!msg.msg_len)
+                {
+                    //peer closed
+                    _lastReadyState &= ~poll::descriptor::rsf_read;
+                    _lastReadyState |= poll::descriptor::rsf_eof;
+                    return 0 < totalReaded;
+                }
+
+                totalReaded += msg.msg_len;
+
+                if(uint64 timestamp = utils::ancillary::parse(msg.msg_hdr)._timestamp)
+                {
+                    methods()->timestamp(timestamp);
+                }
+
+                if(MSG_TRUNC & msg.msg_hdr.msg_flags)
+                {
+                    methods()->failed(utils::makeError<api::InvalidArgument>("message truncated"));
+                }
+                else
+                {
+                    methods()->received(recvBuffer->detach(i));
+                }
+
+                if(!_connected)
+                {
+                    return false;
+                }
+            }
+
+            if(static_cast<uint32>(res) < requested)
+            {
+                _lastReadyState &= ~poll::descriptor::rsf_read;
+                break;
+            }
+        }
+
+        return 0 < totalReaded;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::offerRing(poll::descriptor::Native native)
+    {
+        if(!_ringSize)
+        {
+            return;
+        }
+
+        //any failure before the offer is sent leaves the plain socket
+        std::unique_ptr<Ring> ring{new Ring};
+        if(ring->create(_ringSize))
+        {
+            return;
+        }
+
+        Ring::Offer offer = ring->offer();
+        std::array<int, Ring::_fdsAmount> fds = ring->fds();
+
+        iovec iov{&offer, sizeof(offer)};
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))] = {};
+        msghdr msg{nullptr, 0, &iov, 1, control, sizeof(control), 0};
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(fds));
+
+        //fresh socket, the small offer goes whole or not at all
+        if(sizeof(offer) != ::sendmsg(native, &msg, MSG_NOSIGNAL))
+        {
+            return;
+        }
+
+        ring->offered();
+        startRing(std::move(ring));
+
+        //both directions stay on the socket until the ack, it comes first if the peer takes the ring
+        _ringOffered = true;
+        _ringAckWait = true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::acceptRing(poll::descriptor::Native native, bool forWrite)
+    {
+        dbgAssert(_ringPending || _ringDecline);
+
+        //peek without descriptors, the peer may be a plain client
+        Ring::Offer offer;
+        ssize_t res = ::recv(native, &offer, sizeof(offer), MSG_PEEK);
+        if(0 > res)
+        {
+            if(EAGAIN == errno)
+            {
+                _lastReadyState &= ~poll::descriptor::rsf_read;
+
+                if(forWrite)
+                {
+                    //own data goes first, the ack could not be the first bytes back anymore
+                    _ringPending = false;
+                    _ringDecline = true;
+                    return true;
+                }
+
+                return false;
+            }
+
+            _ringPending = false;
+            _ringDecline = false;
+            failed(utils::fetchSystemError(), true);
+            return false;
+        }
+
+        std::size_t magicPart = std::min(static_cast<std::size_t>(res), sizeof(Ring::_magic));
+        if(!res || memcmp(offer._magic, Ring::_magic, magicPart))
+        {
+            //peer closed or plain data, continue as is
+            _ringPending = false;
+            _ringDecline = false;
+            return true;
+        }
+
+        if(static_cast<std::size_t>(res) < sizeof(offer))
+        {
+            _lastReadyState &= ~poll::descriptor::rsf_read;
+            return false;
+        }
+
+        std::array<int, Ring::_fdsAmount> fds;
+        fds.fill(-1);
+        std::size_t fdsAmount = 0;
+
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fds))];
+        iovec iov{&offer, sizeof(offer)};
+        msghdr msg{nullptr, 0, &iov, 1, control, sizeof(control), 0};
+        res = ::recvmsg(native, &msg, MSG_CMSG_CLOEXEC);
+
+        for(cmsghdr* cmsg = 0 < res ? CMSG_FIRSTHDR(&msg) : nullptr; cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if(SOL_SOCKET == cmsg->cmsg_level && SCM_RIGHTS == cmsg->cmsg_type)
+            {
+                std::size_t amount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for(std::size_t i(0); i<amount; ++i)
+                {
+                    int v;
+                    memcpy(&v, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(v));
+                    if(fdsAmount < fds.size())
+                    {
+                        fds[fdsAmount++] = v;
+                    }
+                    else
+                    {
+                        ::close(v);
+                    }
+                }
+            }
+        }
+
+        bool decline = _ringDecline;
+        _ringPending = false;
+        _ringDecline = false;
+
+        if(sizeof(offer) != static_cast<std::size_t>(res) || fds.size() != fdsAmount || decline)
+        {
+            for(std::size_t i(0); i<fdsAmount; ++i)
+            {
+                ::close(fds[i]);
+            }
+
+            if(decline && 0 < res)
+            {
+                //the offerer falls back on the first bytes back, the offer itself is just dropped
+                return true;
+            }
+
+            failed(utils::makeError<api::ConnectionAborted>("bad shared ring offer"), true);
+            return false;
+        }
+
+        std::unique_ptr<Ring> ring{new Ring};
+        std::error_code ec = ring->attach(offer, fds);
+        if(ec)
+        {
+            failed(utils::makeError(ec), true);
+            return false;
+        }
+
+        startRing(std::move(ring));
+
+        //the ack goes before any own data, then own writes go to the ring;
+        //the peer writes the socket until it sees the ack, that data is read up to its own ack
+        _ringAckSend = true;
+        _ringAckWait = true;
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::sendRingAck(poll::descriptor::Native native)
+    {
+        dbgAssert(_ringAckSend);
+
+        //one byte with a descriptor attached, the peer sees where the socket data ends
+        char ack = 0;
+        iovec iov{&ack, sizeof(ack)};
+
+        int fd = _ringWake.native();
+        alignas(cmsghdr) char control[CMSG_SPACE(sizeof(fd))] = {};
+        msghdr msg{nullptr, 0, &iov, 1, control, sizeof(control), 0};
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(fd));
+        memcpy(CMSG_DATA(cmsg), &fd, sizeof(fd));
+
+        ssize_t res = ::sendmsg(native, &msg, MSG_NOSIGNAL);
+        if(sizeof(ack) == res)
+        {
+            _ringAckSend = false;
+            return true;
+        }
+
+        _lastReadyState &= ~poll::descriptor::rsf_write;
+        if(0 > res && EAGAIN != errno)
+        {
+            failed(utils::fetchSystemError(), true);
+        }
+
+        return false;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::startRing(std::unique_ptr<Ring>&& ring)
+    {
+        std::error_code ec = _ringWake.attach(ring->releaseWakeFd());
+        if(ec)
+        {
+            failed(utils::makeError(ec), true);
+            return;
+        }
+
+        _ringWake.ready() += _sockReadyOwner * [this](poll::descriptor::Native, poll::descriptor::ReadyStateFlags){ringWakeReady();};
+        _ring = std::move(ring);
+
+        //both directions are to be probed
+        _lastReadyState |= poll::descriptor::rsf_read|poll::descriptor::rsf_write;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::stopRing()
+    {
+        _ringPending = false;
+        _ringDecline = false;
+        _ringOffered = false;
+        _ringAckSend = false;
+        _ringAckWait = false;
+        _ringWake.close();
+        _ring.reset();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Channel::ringWakeReady()
+    {
+        uint64 v;
+        while(0 < ::read(_ringWake.native(), &v, sizeof(v)))
+        {
+        }
+
+        if(_connected && _ring)
+        {
+            connectedSockReady(_sock.native(), poll::descriptor::rsf_read|poll::descriptor::rsf_write);
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::doWriteRing(bool preCloseMode)
+    {
+        uint64 totalWrote = 0;
+
+        while((poll::descriptor::rsf_write & _lastReadyState) && !_sendBuffer.empty())
+        {
+            Buf* bufs = _sendBuffer.bufs();
+            uint32 bufsAmount = _sendBuffer.bufsAmount();
+
+            uint32 wrote = 0;
+            bool full = false;
+            for(uint32 i(0); i<bufsAmount && !full; ++i)
+            {
+                uint32 len = static_cast<uint32>(bufs[i].len());
+                uint32 part = _ring->write(bufs[i].data(), len);
+                wrote += part;
+                full = part < len;
+            }
+
+            if(_ring->broken())
+            {
+                if(!preCloseMode)
+                {
+                    failed(utils::makeError<api::ConnectionAborted>("shared ring is broken"), true);
+                }
+                return false;
+            }
+
+            if(wrote)
+            {
+                totalWrote += wrote;
+                _sendBuffer.drop(wrote);
+            }
+
+            if(full && _ring->waitWritable())
+            {
+                _lastReadyState &= ~poll::descriptor::rsf_write;
+                break;
+            }
+        }
+
+        if(!preCloseMode && totalWrote)
+        {
+            methods()->sended(totalWrote, _sendBuffer.dataSize());
+        }
+
+        return 0 < totalWrote;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Channel::doReadRing()
+    {
+        uint32 totalReaded = 0;
+
+        while((poll::descriptor::rsf_read & _lastReadyState) && (_receiveGranula || !_exactRequests.empty()))
+        {
+            uint32 available = _ring->readable();
+            if(_ring->broken())
+            {
+                failed(utils::makeError<api::ConnectionAborted>("shared ring is broken"), true);
+                return false;
+            }
+
+            if(!available)
+            {
+                if(_ring->waitReadable())
+                {
+                    _lastReadyState &= ~poll::descriptor::rsf_read;
+                    break;
+                }
+                continue;
+            }
+
+            Bytes data = _ring->read(std::min(available, _exactRequests.empty() ? _receiveGranula : exactRemaining()));
+            totalReaded += static_cast<uint32>(data.size());
+            _ringReceived += data.size();
+
+            if(_exactRequests.empty())
+            {
+                methods()->received(std::move(data));
+            }
+            else
+            {
+                exactReceived(std::move(data));
+            }
+
+            if(!_ring)
+            {
+                //closed by the handler
+                return false;
+            }
+        }
+
+        return 0 < totalReaded;
+    }
+#endif
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void Channel::connectSockReady(poll::descriptor::Native /*native*/, poll::descriptor::ReadyStateFlags readyState)
     {
@@ -484,6 +1327,9 @@ namespace dci::module::net::stream
             _lastReadyState |= readyState;
             _sockReadyOwner.flush();
             _sock.ready() += _sockReadyOwner * [this](poll::descriptor::Native native, poll::descriptor::ReadyStateFlags readyState){connectedSockReady(native, readyState);};
+#ifndef _WIN32
+            offerRing(_sock.native());
+#endif
 
             connectPromise.resolveValue(api::stream::Channel<>(*this));
             return;
@@ -521,6 +1367,13 @@ namespace dci::module::net::stream
                 return;
             }
 
+#ifndef _WIN32
+            if((_ringPending || _ringDecline) && (poll::descriptor::rsf_read & _lastReadyState))
+            {
+                someProcessed |= acceptRing(native);
+            }
+#endif
+
             if(poll::descriptor::rsf_write & _lastReadyState)
             {
                 someProcessed |= doWrite(native);
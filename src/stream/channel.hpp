@@ -12,6 +12,7 @@
 #include "../optionsStore.hpp"
 #include "../utils/recvBuffer.hpp"
 #include "sendBuffer.hpp"
+#include "ring.hpp"
 
 namespace dci::module::net
 {
@@ -30,22 +31,48 @@ namespace dci::module::net
                     Host* host,
                     poll::descriptor::Native sock,
                     const api::Endpoint& localEndpoint,
-                    api::Endpoint&& remoteEndpoint);
+                    api::Endpoint&& remoteEndpoint,
+                    bool seqpacket = false);
 
             ~Channel();
 
         public:
             cmt::Future<api::stream::Channel<>> connect(bool needBind);
 
+            //accepting side of the shared ring handshake, the first bytes from the peer may be an offer
+            void awaitRing();
+
         private:
             void setReceiveGranula(uint64 granula);
 
+            cmt::Future<Bytes> receiveExact(uint64 size);
+            uint32 exactRemaining() const;
+            void exactReceived(Bytes&& data);
+            void exactFailed(ExceptionPtr e);
+            void updateReceiveLowat();
+
+            void pushMessage(Bytes&& data);
+
             void failed(ExceptionPtr e, bool doClose = false);
             void shutdown(bool input, bool output);
             void close();
 
             bool doWrite(poll::descriptor::Native native, bool preCloseMode = false);
             bool doRead(poll::descriptor::Native native);
+#ifndef _WIN32
+            bool doWriteMessages(poll::descriptor::Native native, bool preCloseMode);
+            bool doReadMessages(poll::descriptor::Native native);
+            int sendFlat(poll::descriptor::Native native, const Bytes& data);
+
+            void offerRing(poll::descriptor::Native native);
+            bool acceptRing(poll::descriptor::Native native, bool forWrite = false);
+            bool sendRingAck(poll::descriptor::Native native);
+            void startRing(std::unique_ptr<Ring>&& ring);
+            void stopRing();
+            void ringWakeReady();
+            bool doWriteRing(bool preCloseMode);
+            bool doReadRing();
+#endif
 
             void connectSockReady(poll::descriptor::Native native, poll::descriptor::ReadyStateFlags readyState);
             void connectedSockReady(poll::descriptor::Native native, poll::descriptor::ReadyStateFlags readyState);
@@ -56,6 +83,7 @@ namespace dci::module::net
             sbs::Owner          _sockReadyOwner;
             api::Endpoint       _localEndpoint;
             api::Endpoint       _remoteEndpoint;
+            bool                _seqpacket;
 
             SendBuffer                              _sendBuffer;
             poll::descriptor::ReadyStateFlags       _lastReadyState{};
@@ -63,6 +91,32 @@ namespace dci::module::net
 
             bool                _connected = false;
             uint32              _receiveGranula = 0;
+
+            struct ExactRequest
+            {
+                uint32              _size;
+                cmt::Promise<Bytes> _promise;
+            };
+            std::deque<ExactRequest>    _exactRequests;
+            Bytes                       _exactAccumulator;
+            uint32                      _receiveLowat = 1;
+
+            //seqpacket mode, whole messages instead of the byte stream
+            std::deque<Bytes>           _messages;
+            uint32                      _messagesSize = 0;
+
+#ifndef _WIN32
+            //shared ring mode, the socket is only for the handshake and closing
+            uint32                      _ringSize = 0;//SharedRing option of the connecting side
+            bool                        _ringPending = false;//accepting side, reads wait for the offer or plain data
+            bool                        _ringDecline = false;//accepting side, own data went first, an offer is dropped
+            bool                        _ringOffered = false;//connecting side, writes stay on the socket until the ack
+            bool                        _ringAckSend = false;//own writes go to the ring after the ack
+            bool                        _ringAckWait = false;//socket data is read until the peer ack
+            uint64                      _ringReceived = 0;
+            std::unique_ptr<Ring>       _ring;
+            poll::Descriptor            _ringWake;
+#endif
         };
     }
 }
@@ -8,13 +8,15 @@
 #include "pch.hpp"
 #include "client.hpp"
 #include "../host.hpp"
+#include "../utils/makeError.hpp"
 
 namespace dci::module::net::stream
 {
-    Client::Client(Host* host)
+    Client::Client(Host* host, bool seqpacket)
         : api::stream::Client<>::Opposite{idl::interface::Initializer{}}
         , _host(host)
         , _binded(false)
+        , _seqpacket(seqpacket)
     {
         _host->track(this);
 
@@ -33,7 +35,21 @@ namespace dci::module::net::stream
 
         methods()->connect() += this * [this](auto&& endpoint)
         {
-            stream::Channel* c = new stream::Channel{_host, {}, _bindEndpoint, api::Endpoint(std::forward<decltype(endpoint)>(endpoint))};
+            api::Endpoint remoteEndpoint{std::forward<decltype(endpoint)>(endpoint)};
+            if(_seqpacket && !remoteEndpoint.holds<api::LocalEndpoint>())
+            {
+                return utils::makeError<api::stream::Channel<>, api::InvalidArgument>("local endpoint expected");
+            }
+
+            if(!_seqpacket)
+            {
+                if(stream::Server* s = _host->inProcessServer(remoteEndpoint))
+                {
+                    return s->connectInProcess(_bindEndpoint, remoteEndpoint);
+                }
+            }
+
+            stream::Channel* c = new stream::Channel{_host, {}, _bindEndpoint, std::move(remoteEndpoint), _seqpacket};
             c->involvedChanged() += c * [c](bool v)
             {
                 if(!v)
@@ -22,7 +22,8 @@ namespace dci::module::net
             , private OptionsStore
         {
         public:
-            Client(Host* host);
+            //seqpacket - AF_UNIX SOCK_SEQPACKET instead of SOCK_STREAM
+            Client(Host* host, bool seqpacket = false);
             ~Client();
 
         private:
@@ -31,6 +32,7 @@ namespace dci::module::net
             Host *          _host;
             api::Endpoint   _bindEndpoint;
             bool            _binded = false;
+            bool            _seqpacket;
         };
     }
 }
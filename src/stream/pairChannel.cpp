@@ -0,0 +1,366 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "pairChannel.hpp"
+#include "../utils/makeError.hpp"
+
+namespace dci::module::net::stream
+{
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::pair<PairChannel*, PairChannel*> PairChannel::make(const api::Endpoint& connectorEndpoint, const api::Endpoint& acceptorEndpoint)
+    {
+        std::shared_ptr<Link> link = std::make_shared<Link>();
+
+        PairChannel* connector = new PairChannel{link, 0, connectorEndpoint, acceptorEndpoint};
+        PairChannel* acceptor = new PairChannel{link, 1, acceptorEndpoint, connectorEndpoint};
+
+        for(PairChannel* c : {connector, acceptor})
+        {
+            c->involvedChanged() += c * [c](bool v)
+            {
+                if(!v)
+                {
+                    delete c;
+                }
+            };
+        }
+
+        return {connector, acceptor};
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    PairChannel::PairChannel(const std::shared_ptr<Link>& link, uint32 side, const api::Endpoint& localEndpoint, const api::Endpoint& remoteEndpoint)
+        : api::stream::Channel<>::Opposite(idl::interface::Initializer())
+        , _link{link}
+        , _side{side}
+        , _localEndpoint{localEndpoint}
+        , _remoteEndpoint{remoteEndpoint}
+    {
+        _link->_ends[_side] = this;
+
+        methods()->setOption() += this * [&](const api::Option&)
+        {
+            //no socket behind
+            return cmt::readyFuture(None{});
+        };
+
+        methods()->localEndpoint() += this * [&]()
+        {
+            return cmt::readyFuture(_localEndpoint);
+        };
+
+        methods()->remoteEndpoint() += this * [&]()
+        {
+            return cmt::readyFuture(_remoteEndpoint);
+        };
+
+        methods()->send() += this * [&](auto&& bytes)
+        {
+            send(Bytes{std::forward<decltype(bytes)>(bytes)});
+        };
+
+        methods()->sendv() += this * [&](auto&& bytesList)
+        {
+            for(auto&& bytes : bytesList)
+            {
+                send(Bytes{std::move(bytes)});
+            }
+        };
+
+        methods()->sharedRingReceived() += this * [&]()
+        {
+            return cmt::readyFuture(uint64{});
+        };
+
+        methods()->setReceiveGranula() += this * [&](uint64 granula)
+        {
+            setReceiveGranula(granula);
+        };
+
+        methods()->startReceive() += this * [&]()
+        {
+            setReceiveGranula(std::numeric_limits<uint32>::max());
+        };
+
+        methods()->stopReceive() += this * [&]()
+        {
+            setReceiveGranula(0);
+        };
+
+        methods()->receiveExact() += this * [&](uint64 size)
+        {
+            return receiveExact(size);
+        };
+
+        methods()->shutdown() += this * [&](bool input, bool output)
+        {
+            shutdown(input, output);
+        };
+
+        methods()->close() += this * [&]()
+        {
+            close();
+        };
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    PairChannel::~PairChannel()
+    {
+        sbs::Owner::flush();
+
+        if(PairChannel* p = peer())
+        {
+            p->_eof = true;
+            p->schedule();
+        }
+        _link->_ends[_side] = nullptr;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    PairChannel* PairChannel::peer() const
+    {
+        return _connected ? _link->_ends[1 - _side] : nullptr;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PairChannel::send(Bytes&& data)
+    {
+        PairChannel* p = peer();
+        if(!p || p->_eof)
+        {
+            methods()->failed(utils::makeError<api::NotConnected>());
+            return;
+        }
+
+        if(data.empty())
+        {
+            return;
+        }
+
+        _outbound.end().write(std::move(data));
+        schedule();
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PairChannel::schedule()
+    {
+        if(_link->_scheduled)
+        {
+            return;
+        }
+        _link->_scheduled = true;
+
+        //events go from the loop as with sockets, never from inside of the caller
+        cmt::spawn() += [link = _link]
+        {
+            link->_scheduled = false;
+
+            for(uint32 side : {0u, 1u})
+            {
+                if(PairChannel* c = link->_ends[side])
+                {
+                    c->pump();
+                }
+            }
+        };
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PairChannel::pump()
+    {
+        api::stream::Channel<>::Opposite si = *this;
+
+        if(PairChannel* p = peer(); p && p->_connected && !_outbound.empty() && p->_inbound.size() < _inboundMax)
+        {
+            Bytes part = take(_outbound, _inboundMax - p->_inbound.size());
+            _sendedPending += part.size();
+            p->_inbound.end().write(std::move(part));
+
+            //the peer may be pumped already in this round
+            schedule();
+        }
+
+        if(_sendedPending)
+        {
+            si->sended(std::exchange(_sendedPending, 0), _outbound.size());
+        }
+
+        uint64 inboundSize = _inbound.size();
+        dci::utils::AtScopeExit consumed{[&]
+        {
+            //room for the rest of the sender
+            PairChannel* p = peer();
+            if(p && !p->_outbound.empty() && _inbound.size() < inboundSize)
+            {
+                schedule();
+            }
+        }};
+
+        while(_connected && !_inbound.empty() && !_inputShut)
+        {
+            if(!_exactRequests.empty())
+            {
+                uint32 rest = _exactRequests.front()._size - static_cast<uint32>(_exactAccumulator.size());
+                _exactAccumulator.end().write(take(_inbound, rest));
+                if(_exactAccumulator.size() < _exactRequests.front()._size)
+                {
+                    continue;
+                }
+
+                cmt::Promise<Bytes> promise = std::move(_exactRequests.front()._promise);
+                _exactRequests.pop_front();
+
+                if(promise.resolved())
+                {
+                    si->received(std::move(_exactAccumulator));
+                }
+                else
+                {
+                    promise.resolveValue(std::move(_exactAccumulator));
+                }
+                _exactAccumulator.clear();
+                continue;
+            }
+
+            if(!_receiveGranula)
+            {
+                break;
+            }
+
+            si->received(take(_inbound, _receiveGranula));
+        }
+
+        if(_connected && _eof && (_inbound.empty() || _inputShut))
+        {
+            close();
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PairChannel::setReceiveGranula(uint64 granula)
+    {
+        if(granula > std::numeric_limits<uint32>::max())
+        {
+            methods()->failed(utils::makeError<api::InvalidArgument>());
+            return;
+        }
+
+        _receiveGranula = static_cast<uint32>(granula);
+
+        if(_receiveGranula && !_inbound.empty())
+        {
+            schedule();
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    cmt::Future<Bytes> PairChannel::receiveExact(uint64 size)
+    {
+        if(!_connected)
+        {
+            return cmt::readyFuture<Bytes>(utils::makeError<api::NotConnected>());
+        }
+
+        if(size > std::numeric_limits<uint32>::max())
+        {
+            return cmt::readyFuture<Bytes>(utils::makeError<api::InvalidArgument>());
+        }
+
+        if(!size)
+        {
+            return cmt::readyFuture(Bytes{});
+        }
+
+        _exactRequests.emplace_back(ExactRequest{static_cast<uint32>(size), {}});
+        cmt::Future<Bytes> res = _exactRequests.back()._promise.future();
+
+        if(!_inbound.empty())
+        {
+            schedule();
+        }
+
+        return res;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Bytes PairChannel::take(Bytes& src, uint64 limit)
+    {
+        if(src.size() <= limit)
+        {
+            return std::exchange(src, Bytes{});
+        }
+
+        //split by relinking, only a chunk on the boundary is divided
+        return src.begin().detach(static_cast<uint32>(limit));
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PairChannel::exactFailed(ExceptionPtr e)
+    {
+        std::deque<ExactRequest> exactRequests;
+        exactRequests.swap(_exactRequests);
+        _exactAccumulator.clear();
+
+        for(ExactRequest& r : exactRequests)
+        {
+            if(!r._promise.resolved())
+            {
+                r._promise.resolveException(e);
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PairChannel::shutdown(bool input, bool output)
+    {
+        if(!_connected)
+        {
+            return;
+        }
+
+        if(input)
+        {
+            _inputShut = true;
+            _receiveGranula = 0;
+        }
+
+        if(output)
+        {
+            if(PairChannel* p = peer())
+            {
+                p->_eof = true;
+                p->schedule();
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void PairChannel::close()
+    {
+        if(!_connected)
+        {
+            return;
+        }
+
+        //sent data goes to the peer whole, it gets the rest and then closes
+        if(PairChannel* p = peer())
+        {
+            p->_inbound.end().write(std::move(_outbound));
+            p->_eof = true;
+            p->schedule();
+        }
+
+        _connected = false;
+        _inbound.clear();
+        _outbound.clear();
+        _sendedPending = 0;
+        exactFailed(exception::buildInstance<api::ConnectionClosed>());
+
+        methods()->closed();
+    }
+}
@@ -0,0 +1,73 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+
+namespace dci::module::net::stream
+{
+    //in-process stream channel, wired directly to another one, data is moved without sockets
+    class PairChannel
+        : public api::stream::Channel<>::Opposite
+        , public sbs::Owner
+        , public mm::heap::Allocable<PairChannel>
+    {
+    public:
+        //both ends, the first is for the connecting side
+        static std::pair<PairChannel*, PairChannel*> make(const api::Endpoint& connectorEndpoint, const api::Endpoint& acceptorEndpoint);
+
+        ~PairChannel();
+
+    private:
+        struct Link
+        {
+            PairChannel *   _ends[2] {};
+            bool            _scheduled = false;
+        };
+
+        PairChannel(const std::shared_ptr<Link>& link, uint32 side, const api::Endpoint& localEndpoint, const api::Endpoint& remoteEndpoint);
+
+        PairChannel* peer() const;
+        void send(Bytes&& data);
+        void schedule();
+        void pump();
+
+        void setReceiveGranula(uint64 granula);
+        cmt::Future<Bytes> receiveExact(uint64 size);
+        static Bytes take(Bytes& src, uint64 limit);
+        void exactFailed(ExceptionPtr e);
+
+        void shutdown(bool input, bool output);
+        void close();
+
+    private:
+        std::shared_ptr<Link>   _link;
+        uint32                  _side;
+        api::Endpoint           _localEndpoint;
+        api::Endpoint           _remoteEndpoint;
+
+        bool                    _connected = true;
+        bool                    _inputShut = false;
+        bool                    _eof = false;//peer shut output or closed, the inbound is the rest
+
+        //as with a socket buffer, the rest waits at the sender until the peer consumes
+        static constexpr uint64 _inboundMax = 256*1024;
+
+        Bytes                   _inbound;
+        Bytes                   _outbound;
+        uint64                  _sendedPending = 0;
+        uint32                  _receiveGranula = 0;
+
+        struct ExactRequest
+        {
+            uint32              _size;
+            cmt::Promise<Bytes> _promise;
+        };
+        std::deque<ExactRequest>    _exactRequests;
+        Bytes                       _exactAccumulator;
+    };
+}
@@ -0,0 +1,329 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#include "pch.hpp"
+#include "ring.hpp"
+#include "../utils/makeError.hpp"
+
+#ifndef _WIN32
+namespace dci::module::net::stream
+{
+    namespace
+    {
+        //wake descriptors come from the peer, nothing but eventfd is to be written and polled
+        bool isEventFd(int fd)
+        {
+            std::string path = "/proc/self/fd/" + std::to_string(fd);
+
+            static constexpr char expected[] = "anon_inode:[eventfd]";
+            char target[sizeof(expected)];
+            ssize_t len = ::readlink(path.c_str(), target, sizeof(target));
+
+            return sizeof(expected)-1 == len && !memcmp(target, expected, sizeof(expected)-1);
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Ring::Ring()
+    {
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Ring::~Ring()
+    {
+        if(_mem)
+        {
+            ::munmap(_mem, _headerSize + std::size_t{_size} * 2);
+        }
+
+        for(int fd : {_memFd, _ownWakeFd, _peerWakeFd})
+        {
+            if(0 <= fd)
+            {
+                ::close(fd);
+            }
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::error_code Ring::create(uint32 size)
+    {
+        dbgAssert(!_mem);
+
+        _side = 0;
+        _size = std::bit_ceil(std::clamp(size, _minSize, _maxSize));
+
+        _memFd = ::memfd_create("dci-net-ring", MFD_CLOEXEC|MFD_ALLOW_SEALING);
+        if(0 > _memFd)
+        {
+            return utils::fetchSystemErrorCode();
+        }
+
+        if(::ftruncate(_memFd, static_cast<off_t>(_headerSize + std::size_t{_size} * 2)))
+        {
+            return utils::fetchSystemErrorCode();
+        }
+
+        //size is fixed before the offer, the peer checks it
+        if(::fcntl(_memFd, F_ADD_SEALS, F_SEAL_SHRINK|F_SEAL_GROW|F_SEAL_SEAL))
+        {
+            return utils::fetchSystemErrorCode();
+        }
+
+        _ownWakeFd = ::eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+        _peerWakeFd = ::eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+        if(0 > _ownWakeFd || 0 > _peerWakeFd)
+        {
+            return utils::fetchSystemErrorCode();
+        }
+
+        //fresh memfd is zeroed, that is the initial state of indices
+        return map(_memFd);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Ring::Offer Ring::offer() const
+    {
+        Offer res{};
+        memcpy(res._magic, _magic, sizeof(_magic));
+        res._size = _size;
+        return res;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::array<int, Ring::_fdsAmount> Ring::fds() const
+    {
+        dbgAssert(!_side);
+        return {_memFd, _ownWakeFd, _peerWakeFd};
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Ring::offered()
+    {
+        //the mapping stays, the peer has own descriptor
+        ::close(_memFd);
+        _memFd = -1;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::error_code Ring::attach(const Offer& offer, const std::array<int, _fdsAmount>& fds)
+    {
+        dbgAssert(!_mem);
+
+        _side = 1;
+        _ownWakeFd = fds[2];
+        _peerWakeFd = fds[1];
+
+        int memFd = fds[0];
+        dci::utils::AtScopeExit closeMem{[&]{::close(memFd);}};
+
+        if(memcmp(offer._magic, _magic, sizeof(_magic)) ||
+           offer._size < _minSize || offer._size > _maxSize || !std::has_single_bit(offer._size))
+        {
+            return std::make_error_code(std::errc::invalid_argument);
+        }
+        _size = offer._size;
+
+        //unsealed memory may be truncated by the peer under the mapping
+        int seals = ::fcntl(memFd, F_GET_SEALS);
+        if(0 > seals)
+        {
+            return utils::fetchSystemErrorCode();
+        }
+
+        if((F_SEAL_SHRINK|F_SEAL_GROW) != (seals & (F_SEAL_SHRINK|F_SEAL_GROW)))
+        {
+            return std::make_error_code(std::errc::permission_denied);
+        }
+
+        if(!isEventFd(_ownWakeFd) || !isEventFd(_peerWakeFd))
+        {
+            return std::make_error_code(std::errc::invalid_argument);
+        }
+
+        struct stat st;
+        if(::fstat(memFd, &st))
+        {
+            return utils::fetchSystemErrorCode();
+        }
+
+        if(static_cast<uint64>(st.st_size) < _headerSize + uint64{_size} * 2)
+        {
+            return std::make_error_code(std::errc::invalid_argument);
+        }
+
+        return map(memFd);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    int Ring::releaseWakeFd()
+    {
+        return std::exchange(_ownWakeFd, -1);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Ring::broken() const
+    {
+        return _broken;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 Ring::write(const void* data, uint32 size)
+    {
+        Half& h = half(_side);
+
+        uint64 head = h._head._value.load(std::memory_order_relaxed);
+        uint64 tail = h._tail._value.load(std::memory_order_acquire);
+        if(head - tail > _size)
+        {
+            _broken = true;
+            return 0;
+        }
+
+        size = std::min(size, static_cast<uint32>(_size - (head - tail)));
+        if(!size)
+        {
+            return 0;
+        }
+
+        byte* dst = area(_side);
+        uint32 offset = static_cast<uint32>(head & (_size - 1));
+        uint32 first = std::min(size, _size - offset);
+        memcpy(dst + offset, data, first);
+        memcpy(dst, static_cast<const byte*>(data) + first, size - first);
+
+        h._head._value.store(head + size, std::memory_order_seq_cst);
+
+        //the consumer checks head after raising the flag, so one of the sides sees the other
+        if(h._tail._sleeping.load(std::memory_order_seq_cst) && h._tail._sleeping.exchange(0))
+        {
+            notify();
+        }
+
+        return size;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Ring::waitWritable()
+    {
+        Half& h = half(_side);
+
+        h._head._sleeping.store(1, std::memory_order_seq_cst);
+
+        uint64 head = h._head._value.load(std::memory_order_relaxed);
+        uint64 tail = h._tail._value.load(std::memory_order_seq_cst);
+        if(head - tail < _size)
+        {
+            h._head._sleeping.store(0, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    uint32 Ring::readable()
+    {
+        Half& h = half(1 - _side);
+
+        uint64 tail = h._tail._value.load(std::memory_order_relaxed);
+        uint64 head = h._head._value.load(std::memory_order_acquire);
+        if(head - tail > _size)
+        {
+            _broken = true;
+            return 0;
+        }
+
+        return static_cast<uint32>(head - tail);
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Bytes Ring::read(uint32 size)
+    {
+        Half& h = half(1 - _side);
+
+        uint64 tail = h._tail._value.load(std::memory_order_relaxed);
+        size = std::min(size, readable());
+
+        Bytes res;
+        if(!size)
+        {
+            return res;
+        }
+
+        const byte* src = area(1 - _side);
+        uint32 offset = static_cast<uint32>(tail & (_size - 1));
+        uint32 first = std::min(size, _size - offset);
+        res.end().write(src + offset, first);
+        if(size > first)
+        {
+            res.end().write(src, size - first);
+        }
+
+        h._tail._value.store(tail + size, std::memory_order_seq_cst);
+
+        if(h._head._sleeping.load(std::memory_order_seq_cst) && h._head._sleeping.exchange(0))
+        {
+            notify();
+        }
+
+        return res;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Ring::waitReadable()
+    {
+        Half& h = half(1 - _side);
+
+        h._tail._sleeping.store(1, std::memory_order_seq_cst);
+
+        uint64 tail = h._tail._value.load(std::memory_order_relaxed);
+        uint64 head = h._head._value.load(std::memory_order_seq_cst);
+        if(head != tail)
+        {
+            h._tail._sleeping.store(0, std::memory_order_relaxed);
+            return false;
+        }
+
+        return true;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::error_code Ring::map(int memFd)
+    {
+        void* mem = ::mmap(nullptr, _headerSize + std::size_t{_size} * 2, PROT_READ|PROT_WRITE, MAP_SHARED, memFd, 0);
+        if(MAP_FAILED == mem)
+        {
+            return utils::fetchSystemErrorCode();
+        }
+
+        _mem = mem;
+        return {};
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Ring::Half& Ring::half(uint32 index)
+    {
+        return static_cast<Half*>(_mem)[index];
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    byte* Ring::area(uint32 index)
+    {
+        return static_cast<byte*>(_mem) + _headerSize + std::size_t{_size} * index;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Ring::notify()
+    {
+        uint64 v = 1;
+        ssize_t res = ::write(_peerWakeFd, &v, sizeof(v));
+        //counter overflow only, the peer is woken up anyway
+        (void)res;
+    }
+}
+#endif
@@ -0,0 +1,95 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+
+#ifndef _WIN32
+namespace dci::module::net::stream
+{
+    //pair of single producer single consumer byte rings in shared memory, one per direction,
+    //side 0 is the connecting one, it writes the ring 0 and reads the ring 1
+    class Ring
+    {
+        Ring(const Ring&) = delete;
+        void operator=(const Ring&) = delete;
+
+    public:
+        //sent by the connecting side over the socket, with memfd and both eventfds attached
+        struct Offer
+        {
+            char    _magic[8];
+            uint32  _size;
+            uint32  _reserved;
+        };
+        static constexpr char _magic[8] = {'d','c','i','r','i','n','g','1'};
+        static constexpr uint32 _minSize = 4096;
+        static constexpr uint32 _maxSize = 1u << 30;
+        static constexpr uint32 _fdsAmount = 3;//memory, wakeup for side 0, wakeup for side 1
+
+    public:
+        Ring();
+        ~Ring();
+
+        //connecting side
+        std::error_code create(uint32 size);
+        Offer offer() const;
+        std::array<int, _fdsAmount> fds() const;
+        void offered();
+
+        //accepting side, owns the descriptors after call
+        std::error_code attach(const Offer& offer, const std::array<int, _fdsAmount>& fds);
+
+        //own wakeup descriptor, raised by the peer, owned by the caller after call
+        int releaseWakeFd();
+
+        bool broken() const;
+
+        //producer
+        uint32 write(const void* data, uint32 size);
+        bool waitWritable();//true - full, the peer will wake up when consumes
+
+        //consumer
+        uint32 readable();
+        Bytes read(uint32 size);
+        bool waitReadable();//true - empty, the peer will wake up when produces
+
+    private:
+        struct alignas(64) Index
+        {
+            std::atomic<uint64> _value;
+            std::atomic<uint32> _sleeping;
+        };
+
+        struct Half
+        {
+            Index _head;//written by the producer, _sleeping - producer waits for space
+            Index _tail;//written by the consumer, _sleeping - consumer waits for data
+        };
+
+        static_assert(std::atomic<uint64>::is_always_lock_free && std::atomic<uint32>::is_always_lock_free, "shared memory needs address-free atomics");
+
+        static constexpr std::size_t _headerSize = 4096;
+        static_assert(sizeof(Half) * 2 <= _headerSize);
+
+        std::error_code map(int memFd);
+        Half& half(uint32 index);
+        byte* area(uint32 index);
+        void notify();
+
+    private:
+        uint32  _side = 0;
+        uint32  _size = 0;
+        void *  _mem = nullptr;
+        bool    _broken = false;
+
+        int     _memFd = -1;
+        int     _ownWakeFd = -1;
+        int     _peerWakeFd = -1;
+    };
+}
+#endif
@@ -38,6 +38,34 @@ namespace dci::module::net::stream
         }
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void SendBuffer::push(const List<Bytes>& data)
+    {
+        for(const Bytes& one : data)
+        {
+            _data.end().write(Bytes(one));
+        }
+
+        if(_bufsAmountMin4Enfill >= _bufsAmount)
+        {
+            enfillBufs();
+        }
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void SendBuffer::push(List<Bytes>&& data)
+    {
+        for(Bytes& one : data)
+        {
+            _data.end().write(std::move(one));
+        }
+
+        if(_bufsAmountMin4Enfill >= _bufsAmount)
+        {
+            enfillBufs();
+        }
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     void SendBuffer::clear()
     {
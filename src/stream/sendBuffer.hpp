@@ -21,6 +21,8 @@ namespace dci::module::net::stream
 
         void push(const Bytes& data);
         void push(Bytes&& data);
+        void push(const List<Bytes>& data);
+        void push(List<Bytes>&& data);
 
         void clear();
         bool empty() const;
@@ -10,20 +10,32 @@
 #include "../host.hpp"
 #include "../utils/sockaddr.hpp"
 #include "../utils/makeError.hpp"
+#include "pairChannel.hpp"
 #include "dci/poll/descriptor/native.hpp"
 
 namespace dci::module::net::stream
 {
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
-    Server::Server(Host* host)
+    Server::Server(Host* host, bool seqpacket)
         : api::stream::Server<>::Opposite(idl::interface::Initializer())
         , _host{host}
+        , _seqpacket{seqpacket}
         , _sock{poll::descriptor::Native{}, [this](poll::descriptor::Native native, poll::descriptor::ReadyStateFlags readyState) {sockReady(native, readyState);}}
     {
         _host->track(this);
 
         methods()->setOption() += this * [&](const api::Option& op)
         {
+            if(op.holds<api::option::SharedRing>())
+            {
+                _sharedRing = 0 != op.get<api::option::SharedRing>().size;
+            }
+
+            if(op.holds<api::option::InProcess>())
+            {
+                _inProcess = op.get<api::option::InProcess>().enable;
+            }
+
             if(_sock.valid())
             {
                 ExceptionPtr e = applyOption(_sock.native(), op);
@@ -58,10 +70,75 @@ namespace dci::module::net::stream
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     Server::~Server()
     {
+        *_self = nullptr;
         sbs::Owner::flush();
         _host->untrack(this);
     }
 
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    bool Server::servesInProcess(const api::Endpoint& target) const
+    {
+        if(!_inProcess || _seqpacket || !_sock.valid())
+        {
+            return false;
+        }
+
+        if(const api::LocalEndpoint* l = std::get_if<api::LocalEndpoint>(&_localEndpoint.std()))
+        {
+            const api::LocalEndpoint* t = std::get_if<api::LocalEndpoint>(&target.std());
+            return t && t->address == l->address;
+        }
+
+        //wildcard listener serves loopback
+        if(const api::Ip4Endpoint* l = std::get_if<api::Ip4Endpoint>(&_localEndpoint.std()))
+        {
+            const api::Ip4Endpoint* t = std::get_if<api::Ip4Endpoint>(&target.std());
+            if(!t || t->port != l->port)
+            {
+                return false;
+            }
+
+            static const Array<uint8, 4> any{};
+            return t->address.octets == l->address.octets || (l->address.octets == any && 127 == t->address.octets[0]);
+        }
+
+        if(const api::Ip6Endpoint* l = std::get_if<api::Ip6Endpoint>(&_localEndpoint.std()))
+        {
+            const api::Ip6Endpoint* t = std::get_if<api::Ip6Endpoint>(&target.std());
+            if(!t || t->port != l->port)
+            {
+                return false;
+            }
+
+            static const Array<uint8, 16> any{};
+            static const Array<uint8, 16> loopback{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,1};
+            return t->address.octets == l->address.octets || (l->address.octets == any && t->address.octets == loopback);
+        }
+
+        return false;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    cmt::Future<api::stream::Channel<>> Server::connectInProcess(const api::Endpoint& connectorEndpoint, const api::Endpoint& target)
+    {
+        dbgAssert(servesInProcess(target));
+
+        auto [connector, acceptor] = PairChannel::make(connectorEndpoint, target);
+
+        //accepted goes from the loop as with sockets, never from inside of the connector
+        cmt::spawn() += [self = _self, channel = api::stream::Channel<>(*acceptor)]() mutable
+        {
+            //server gone or closed meanwhile, the dropped channel is seen closed by the connector
+            Server* s = *self;
+            if(s && s->_sock.valid())
+            {
+                s->methods()->accepted(std::move(channel));
+            }
+        };
+
+        return cmt::readyFuture(api::stream::Channel<>(*connector));
+    }
+
     /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
     cmt::Future<None> Server::listen(auto&& endpoint)
     {
@@ -69,6 +146,12 @@ namespace dci::module::net::stream
 
         _bindEndpoint = std::forward<decltype(endpoint)>(endpoint);
 
+        if(_seqpacket && !_bindEndpoint.holds<api::LocalEndpoint>())
+        {
+            _bindEndpoint = api::Endpoint();
+            return utils::makeError<None, api::InvalidArgument>("local endpoint expected");
+        }
+
         union
         {
             sockaddr            _base;
@@ -80,7 +163,7 @@ namespace dci::module::net::stream
 #ifdef _WIN32
         dci::poll::descriptor::Native native = ::WSASocketW(saddr._base.sa_family, SOCK_STREAM, PF_UNSPEC, nullptr, 0, WSA_FLAG_NO_HANDLE_INHERIT);
 #else
-        poll::descriptor::Native native = ::socket(saddr._base.sa_family, SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
+        poll::descriptor::Native native = ::socket(saddr._base.sa_family, (_seqpacket ? SOCK_SEQPACKET : SOCK_STREAM)|SOCK_NONBLOCK|SOCK_CLOEXEC, 0);
 #endif
 
         if(native._bad == native._value)
@@ -179,7 +262,7 @@ namespace dci::module::net::stream
                     api::Endpoint remoteEndpoint;
                     utils::sockaddr::convert(&saddr._base, saddrLen, remoteEndpoint);
 
-                    stream::Channel* c = new stream::Channel{_host, native2, _localEndpoint, std::move(remoteEndpoint)};
+                    stream::Channel* c = new stream::Channel{_host, native2, _localEndpoint, std::move(remoteEndpoint), _seqpacket};
                     c->involvedChanged() += c * [c](bool v)
                     {
                         if(!v)
@@ -187,6 +270,12 @@ namespace dci::module::net::stream
                             delete c;
                         }
                     };
+
+                    if(_sharedRing && !_seqpacket && _localEndpoint.holds<api::LocalEndpoint>())
+                    {
+                        c->awaitRing();
+                    }
+
                     methods()->accepted(api::stream::Channel<>(*c));
                 }
                 else
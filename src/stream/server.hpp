@@ -22,9 +22,14 @@ namespace dci::module::net
             , private OptionsStore
         {
         public:
-            Server(Host* host);
+            //seqpacket - AF_UNIX SOCK_SEQPACKET instead of SOCK_STREAM
+            Server(Host* host, bool seqpacket = false);
             ~Server();
 
+            //listening endpoint matches target and InProcess option is on
+            bool servesInProcess(const api::Endpoint& target) const;
+            cmt::Future<api::stream::Channel<>> connectInProcess(const api::Endpoint& connectorEndpoint, const api::Endpoint& target);
+
         private:
             cmt::Future<None> listen(auto&& endpoint);
             void close();
@@ -32,9 +37,13 @@ namespace dci::module::net
 
         private:
             Host *              _host;
+            bool                _seqpacket;
+            bool                _sharedRing = false;//accepted channels wait for an offer
+            bool                _inProcess = false;
             api::Endpoint       _bindEndpoint;
             api::Endpoint       _localEndpoint;
             poll::Descriptor    _sock;
+            std::shared_ptr<Server*> _self{std::make_shared<Server*>(this)};//for deferred in-process accepts
         };
     }
 }
@@ -0,0 +1,158 @@
+/* This file is part of the the dci project. Copyright (C) 2013-2023 vopl, shtoba.
+   This program is free software: you can redistribute it and/or modify it under the terms of the GNU Affero General Public
+   License as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+   This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+   of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU Affero General Public License for more details.
+   You should have received a copy of the GNU Affero General Public License along with this program. If not, see <https://www.gnu.org/licenses/>. */
+
+#pragma once
+#include "pch.hpp"
+
+#ifndef _WIN32
+namespace dci::module::net::utils::ancillary
+{
+    struct Values
+    {
+        uint32  _segmentSize = 0;//UDP_GRO
+        uint64  _timestamp = 0;//SO_TIMESTAMPNS, ns since epoch
+        bool    _droppedFetched = false;
+        uint32  _dropped = 0;//SO_RXQ_OVFL, cumulative, wraps
+
+        //IP_PKTINFO/IPV6_PKTINFO, without port
+        union
+        {
+            sockaddr            _base;
+            sockaddr_in         _in;
+            sockaddr_in6        _in6;
+        }       _destination;
+        socklen_t _destinationLen = 0;
+
+        int     _fd = -1;//SCM_RIGHTS, first descriptor only, the rest are closed; owned by the caller
+    };
+
+    inline Values parse(msghdr& msg)
+    {
+        Values res;
+
+        for(cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if(SOL_UDP == cmsg->cmsg_level && UDP_GRO == cmsg->cmsg_type)
+            {
+                int v;
+                memcpy(&v, CMSG_DATA(cmsg), sizeof(v));
+                res._segmentSize = v > 0 ? static_cast<uint32>(v) : 0;
+            }
+            else if(SOL_SOCKET == cmsg->cmsg_level && SCM_TIMESTAMPNS == cmsg->cmsg_type)
+            {
+                timespec v;
+                memcpy(&v, CMSG_DATA(cmsg), sizeof(v));
+                res._timestamp = static_cast<uint64>(v.tv_sec) * 1000000000 + static_cast<uint64>(v.tv_nsec);
+            }
+            else if(SOL_SOCKET == cmsg->cmsg_level && SO_RXQ_OVFL == cmsg->cmsg_type)
+            {
+                memcpy(&res._dropped, CMSG_DATA(cmsg), sizeof(res._dropped));
+                res._droppedFetched = true;
+            }
+            else if(SOL_SOCKET == cmsg->cmsg_level && SCM_RIGHTS == cmsg->cmsg_type)
+            {
+                std::size_t amount = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for(std::size_t i(0); i<amount; ++i)
+                {
+                    int v;
+                    memcpy(&v, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(v));
+
+                    if(0 > res._fd)
+                    {
+                        res._fd = v;
+                    }
+                    else
+                    {
+                        ::close(v);
+                    }
+                }
+            }
+            else if(IPPROTO_IP == cmsg->cmsg_level && IP_PKTINFO == cmsg->cmsg_type)
+            {
+                in_pktinfo v;
+                memcpy(&v, CMSG_DATA(cmsg), sizeof(v));
+
+                res._destination._in = {};
+                res._destination._in.sin_family = AF_INET;
+                res._destination._in.sin_addr = v.ipi_addr;
+                res._destinationLen = sizeof(sockaddr_in);
+            }
+            else if(IPPROTO_IPV6 == cmsg->cmsg_level && IPV6_PKTINFO == cmsg->cmsg_type)
+            {
+                in6_pktinfo v;
+                memcpy(&v, CMSG_DATA(cmsg), sizeof(v));
+
+                res._destination._in6 = {};
+                res._destination._in6.sin6_family = AF_INET6;
+                res._destination._in6.sin6_addr = v.ipi6_addr;
+                if(IN6_IS_ADDR_LINKLOCAL(&v.ipi6_addr))
+                {
+                    res._destination._in6.sin6_scope_id = v.ipi6_ifindex;
+                }
+                res._destinationLen = sizeof(sockaddr_in6);
+            }
+        }
+
+        return res;
+    }
+
+    //for sending, returns used size of buf
+    inline std::size_t build(char* buf, std::size_t bufSize, uint16 segmentSize, uint64 txTime, const api::Endpoint* source)
+    {
+        msghdr msg{};
+        msg.msg_control = buf;
+        msg.msg_controllen = bufSize;
+        memset(buf, 0, bufSize);
+
+        std::size_t used = 0;
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+
+        auto put = [&](int level, int type, const void* data, std::size_t size)
+        {
+            dbgAssert(cmsg && used + CMSG_SPACE(size) <= bufSize);
+
+            cmsg->cmsg_level = level;
+            cmsg->cmsg_type = type;
+            cmsg->cmsg_len = CMSG_LEN(size);
+            memcpy(CMSG_DATA(cmsg), data, size);
+
+            used += CMSG_SPACE(size);
+            cmsg = CMSG_NXTHDR(&msg, cmsg);
+        };
+
+        if(segmentSize)
+        {
+            put(SOL_UDP, UDP_SEGMENT, &segmentSize, sizeof(segmentSize));
+        }
+
+        if(txTime)
+        {
+            put(SOL_SOCKET, SCM_TXTIME, &txTime, sizeof(txTime));
+        }
+
+        if(source && source->holds<api::Ip4Endpoint>())
+        {
+            const api::Ip4Address& address = source->get<api::Ip4Endpoint>().address;
+
+            in_pktinfo v{};
+            memcpy(&v.ipi_spec_dst, address.octets.data(), address.octets.size());
+            put(IPPROTO_IP, IP_PKTINFO, &v, sizeof(v));
+        }
+        else if(source && source->holds<api::Ip6Endpoint>())
+        {
+            const api::Ip6Address& address = source->get<api::Ip6Endpoint>().address;
+
+            in6_pktinfo v{};
+            memcpy(&v.ipi6_addr, address.octets.data(), address.octets.size());
+            v.ipi6_ifindex = address.linkId;
+            put(IPPROTO_IPV6, IPV6_PKTINFO, &v, sizeof(v));
+        }
+
+        return used;
+    }
+}
+#endif
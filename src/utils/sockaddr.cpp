@@ -215,4 +215,64 @@ namespace dci::module::net::utils::sockaddr
 
         return true;
     }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    std::size_t KeyHash::operator()(const Key& key) const
+    {
+        return std::hash<std::string_view>{}(std::string_view{reinterpret_cast<const char*>(key._data.data()), key._size});
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    Key key(const ::sockaddr* src, socklen_t srcLen)
+    {
+        Key res;
+
+        auto put = [&](const void* data, std::size_t size)
+        {
+            memcpy(res._data.data() + res._size, data, size);
+            res._size = static_cast<uint8>(res._size + size);
+        };
+
+        if(AF_INET == src->sa_family && srcLen >= static_cast<socklen_t>(sizeof(::sockaddr_in)))
+        {
+            const ::sockaddr_in* src4 = reinterpret_cast<const ::sockaddr_in*>(src);
+            put(&src4->sin_port, sizeof(src4->sin_port));
+            put(&src4->sin_addr, sizeof(src4->sin_addr));
+        }
+        else if(AF_INET6 == src->sa_family && srcLen >= static_cast<socklen_t>(sizeof(::sockaddr_in6)))
+        {
+            const ::sockaddr_in6* src6 = reinterpret_cast<const ::sockaddr_in6*>(src);
+            uint8 tag = 6;
+            put(&tag, sizeof(tag));
+            put(&src6->sin6_port, sizeof(src6->sin6_port));
+            put(&src6->sin6_addr, sizeof(src6->sin6_addr));
+            uint32 scope = src6->sin6_scope_id;
+            put(&scope, sizeof(scope));
+        }
+
+        return res;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    const api::Endpoint& Cache::get(const ::sockaddr* src, socklen_t srcLen)
+    {
+        if(srcLen != _addressLen || memcmp(src, &_address, static_cast<std::size_t>(srcLen)))
+        {
+            _endpoint = api::Endpoint{};
+            convert(src, srcLen, _endpoint);
+
+            _addressLen = std::min(srcLen, static_cast<socklen_t>(sizeof(_address)));
+            memcpy(&_address, src, static_cast<std::size_t>(_addressLen));
+        }
+
+        return _endpoint;
+    }
+
+    /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+    void Cache::put(const ::sockaddr* src, socklen_t srcLen, const api::Endpoint& dst)
+    {
+        _addressLen = std::min(srcLen, static_cast<socklen_t>(sizeof(_address)));
+        memcpy(&_address, src, static_cast<std::size_t>(_addressLen));
+        _endpoint = dst;
+    }
 }
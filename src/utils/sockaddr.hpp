@@ -29,4 +29,37 @@ namespace dci::module::net::utils::sockaddr
     bool convert(const ::sockaddr_un* src, socklen_t srcLen, api::LocalEndpoint& dst);
     bool convert(const ::sockaddr_in* src, socklen_t srcLen, api::Ip4Endpoint& dst);
     bool convert(const ::sockaddr_in6* src, socklen_t srcLen, api::Ip6Endpoint& dst);
+
+    //compact binary form of ip address and port, for hashing
+    struct Key
+    {
+        std::array<uint8, 23>   _data{};
+        uint8                   _size = 0;//0 - not an ip address
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    Key key(const ::sockaddr* src, socklen_t srcLen);
+
+    //last converted address, a peer usually sends many datagrams in a row
+    class Cache
+    {
+    public:
+        const api::Endpoint& get(const ::sockaddr* src, socklen_t srcLen);
+        void put(const ::sockaddr* src, socklen_t srcLen, const api::Endpoint& dst);
+
+    private:
+        union
+        {
+            ::sockaddr          _base;
+            ::sockaddr_storage  _space;
+        }               _address;
+        socklen_t       _addressLen = 0;
+        api::Endpoint   _endpoint;
+    };
 }
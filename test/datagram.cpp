@@ -9,6 +9,7 @@
 #include <dci/host.hpp>
 #include <dci/poll.hpp>
 #include "net.hpp"
+#include <cstdio>
 
 using namespace dci;
 using namespace dci::host;
@@ -110,3 +111,524 @@ TEST(module_net, datagram_large_message)
 
     EXPECT_EQ(1, cnt);
 }
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_localLarge)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    LocalEndpoint ep1{"/tmp/dci-module-net-localLarge1"};
+    LocalEndpoint ep2{"/tmp/dci-module-net-localLarge2"};
+    std::remove(ep1.address.data());
+    std::remove(ep2.address.data());
+
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+
+    //the datagram size is limited by the sender buffer
+    EXPECT_NO_THROW((ch2->setOption(option::SendBuf{1024*1024}).value()));
+
+    std::vector<std::string> received;
+    int failed = 0;
+
+    ch1->received() += [&](Bytes data, Endpoint /*from*/)
+    {
+        received.push_back(data.toString());
+    };
+
+    ch1->failed() += [&](ExceptionPtr)
+    {
+        failed++;
+    };
+
+    //far above an ip datagram, must come whole
+    std::string large(200*1000, '\0');
+    for(std::size_t i(0); i<large.size(); ++i)
+    {
+        large[i] = static_cast<char>('a' + i % 26);
+    }
+
+    ch2->send(Bytes{large}, ep1);
+    ch2->send(Bytes{"small"}, ep1);
+
+    for(int i(0); i<100 && received.size()<2; ++i)
+    {
+        sleep(1);
+    }
+
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_TRUE(received[0] == large);
+    EXPECT_EQ(received[1], "small");
+    EXPECT_EQ(failed, 0);
+
+    ch1->close();
+    ch2->close();
+    std::remove(ep1.address.data());
+    std::remove(ep2.address.data());
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_sendBatch)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+
+    int cnt = 0;
+
+    ch1->received() += [&](Bytes data, Endpoint from)
+    {
+        EXPECT_EQ(1819u, from.get<Ip4Endpoint>().port);
+        EXPECT_EQ(data.toString(), std::to_string(cnt));
+        cnt++;
+    };
+
+    List<datagram::Datagram> batch;
+    for(int i(0); i<100; ++i)
+    {
+        if(!(i % 10))
+        {
+            //skipped, not sent as zero-length datagrams
+            batch.push_back(datagram::Datagram{Bytes{}, ep1});
+        }
+        batch.push_back(datagram::Datagram{Bytes(std::to_string(i)), ep1});
+    }
+    ch2->sendBatch(batch);
+
+    for(int i(0); i<100 && cnt<100; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(100, cnt);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_sendSegmented)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+
+    int cnt = 0;
+
+    ch1->received() += [&](Bytes data, Endpoint /*from*/)
+    {
+        EXPECT_EQ(data.size(), cnt < 10 ? 100u : 50u);
+        cnt++;
+    };
+
+    Bytes data;
+    data.begin().advance(1050);
+    ch2->sendSegmented(data, 100, ep1);
+
+    for(int i(0); i<100 && cnt<11; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(11, cnt);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_receiveCoalescing)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+
+    EXPECT_NO_THROW((ch1->setOption(option::ReceiveCoalescing{true}).value()));
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+
+    int cnt = 0;
+
+    ch1->received() += [&](Bytes data, Endpoint /*from*/)
+    {
+        EXPECT_EQ(data.size(), cnt % 11 < 10 ? 100u : 50u);
+        cnt++;
+    };
+
+    //twice, the second pass goes through the segment aligned layout
+    Bytes data;
+    data.begin().advance(1050);
+    ch2->sendSegmented(data, 100, ep1);
+    ch2->sendSegmented(data, 100, ep1);
+
+    for(int i(0); i<100 && cnt<22; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(22, cnt);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_connected)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+    EXPECT_NO_THROW((ch2->connect(ep1).value()));
+
+    int cnt1 = 0;
+    int cnt2 = 0;
+
+    ch1->received() += [&](Bytes data, Endpoint from)
+    {
+        EXPECT_EQ(1u, from.index());
+        EXPECT_EQ(1819u, from.get<Ip4Endpoint>().port);
+        EXPECT_EQ(data.toString(), "ping");
+
+        cnt1++;
+        ch1->send(Bytes("pong"), from);
+    };
+
+    ch2->received() += [&](Bytes data, Endpoint from)
+    {
+        EXPECT_EQ(1u, from.index());
+        EXPECT_EQ(1818u, from.get<Ip4Endpoint>().port);
+        EXPECT_EQ(data.toString(), "pong");
+
+        cnt2++;
+    };
+
+    for(int i(0); i<10; ++i)
+    {
+        ch2->sendConnected(Bytes("ping"));
+    }
+
+    for(int i(0); i<100 && cnt2<10; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(10, cnt1);
+    EXPECT_EQ(10, cnt2);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_receivedBatch)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+
+    ch1->setBatchReceive(true);
+
+    int cnt = 0;
+    int events = 0;
+
+    ch1->received() += [&](Bytes /*data*/, Endpoint /*from*/)
+    {
+        ADD_FAILURE();
+    };
+
+    ch1->receivedBatch() += [&](List<datagram::Datagram> batch)
+    {
+        EXPECT_FALSE(batch.empty());
+        for(const datagram::Datagram& d : batch)
+        {
+            EXPECT_EQ(1819u, d.peer.get<Ip4Endpoint>().port);
+            EXPECT_EQ(d.data.toString(), std::to_string(cnt));
+            cnt++;
+        }
+        events++;
+    };
+
+    List<datagram::Datagram> batch;
+    for(int i(0); i<100; ++i)
+    {
+        if(!(i % 10))
+        {
+            //skipped, not sent as zero-length datagrams
+            batch.push_back(datagram::Datagram{Bytes{}, ep1});
+        }
+        batch.push_back(datagram::Datagram{Bytes(std::to_string(i)), ep1});
+    }
+    ch2->sendBatch(batch);
+
+    for(int i(0); i<100 && cnt<100; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(100, cnt);
+    EXPECT_LT(events, cnt);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_timestamp)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+
+    EXPECT_NO_THROW((ch1->setOption(option::ReceiveTimestamp{true}).value()));
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+
+    uint64 sent = static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    uint64 stamp = 0;
+    int cnt = 0;
+
+    ch1->timestamp() += [&](uint64 v)
+    {
+        stamp = v;
+    };
+
+    ch1->received() += [&](Bytes data, Endpoint /*from*/)
+    {
+        EXPECT_EQ(data.toString(), "stamped");
+        EXPECT_LE(sent, stamp);
+        cnt++;
+    };
+
+    ch2->send(Bytes("stamped"), ep1);
+
+    for(int i(0); i<100 && !cnt; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(1, cnt);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_pacing)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+
+    int cnt = 0;
+    ch1->received() += [&](Bytes /*data*/, Endpoint /*from*/)
+    {
+        cnt++;
+    };
+
+    //20 datagrams by 1000 bytes at 200000 bytes per second take about 100ms
+    ch2->setPacingRate(200000);
+
+    Bytes data;
+    data.begin().advance(1000);
+
+    auto start = std::chrono::steady_clock::now();
+    for(int i(0); i<20; ++i)
+    {
+        ch2->send(data, ep1);
+    }
+
+    for(int i(0); i<1000 && cnt<20; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(20, cnt);
+    EXPECT_LE(std::chrono::milliseconds{80}, std::chrono::steady_clock::now() - start);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_packetInfo)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+
+    Ip4Endpoint any1{{0,0,0,0}, 1818};
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+
+    EXPECT_NO_THROW((ch1->bind(any1).value()));
+    EXPECT_NO_THROW((ch1->setOption(option::PacketInfo{true}).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+
+    Endpoint destination;
+    int cnt1 = 0;
+    int cnt2 = 0;
+
+    ch1->destination() += [&](Endpoint v)
+    {
+        destination = v;
+    };
+
+    ch1->received() += [&](Bytes data, Endpoint from)
+    {
+        EXPECT_EQ(1u, destination.index());
+        EXPECT_EQ(1818u, destination.get<Ip4Endpoint>().port);
+        EXPECT_EQ((Array<uint8, 4>{127,0,0,1}), destination.get<Ip4Endpoint>().address.octets);
+
+        cnt1++;
+        ch1->sendFrom(std::move(data), from, destination);
+    };
+
+    ch2->received() += [&](Bytes data, Endpoint from)
+    {
+        EXPECT_EQ(1818u, from.get<Ip4Endpoint>().port);
+        EXPECT_EQ((Array<uint8, 4>{127,0,0,1}), from.get<Ip4Endpoint>().address.octets);
+        EXPECT_EQ(data.toString(), "where");
+
+        cnt2++;
+    };
+
+    ch2->send(Bytes("where"), ep1);
+
+    for(int i(0); i<100 && !cnt2; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(1, cnt1);
+    EXPECT_EQ(1, cnt2);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, datagram_peerChannel)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    datagram::Channel<> ch1 = netHost->datagramChannel().value();
+    datagram::Channel<> ch2 = netHost->datagramChannel().value();
+    datagram::Channel<> ch3 = netHost->datagramChannel().value();
+
+    Ip4Endpoint ep1{{127,0,0,1}, 1818};
+    Ip4Endpoint ep2{{127,0,0,1}, 1819};
+    Ip4Endpoint ep3{{127,0,0,1}, 1820};
+
+    EXPECT_NO_THROW((ch1->bind(ep1).value()));
+    EXPECT_NO_THROW((ch2->bind(ep2).value()));
+    EXPECT_NO_THROW((ch3->bind(ep3).value()));
+
+    datagram::PeerChannel<> pc = ch1->peer(ep2).value();
+    EXPECT_EQ(1819u, pc->peer().value().get<Ip4Endpoint>().port);
+
+    //ancillary events go before newPeer as before received
+    EXPECT_NO_THROW((ch1->setOption(option::ReceiveTimestamp{true}).value()));
+
+    int cntPeer = 0;
+    int cntNew = 0;
+    int cntTimestamp = 0;
+    int cnt2 = 0;
+
+    ch1->timestamp() += [&](uint64 ts)
+    {
+        EXPECT_NE(0u, ts);
+        EXPECT_EQ(cntTimestamp, cntNew);
+        cntTimestamp++;
+    };
+
+    ch1->received() += [&](Bytes, Endpoint)
+    {
+        ADD_FAILURE();
+    };
+
+    pc->received() += [&](Bytes data)
+    {
+        EXPECT_EQ(data.toString(), "ping");
+
+        cntPeer++;
+        pc->send(Bytes("pong"));
+    };
+
+    ch1->newPeer() += [&](Endpoint from, Bytes data)
+    {
+        EXPECT_EQ(1u, from.index());
+        EXPECT_EQ(1820u, from.get<Ip4Endpoint>().port);
+        EXPECT_EQ(data.toString(), "hello");
+
+        cntNew++;
+    };
+
+    ch2->received() += [&](Bytes data, Endpoint)
+    {
+        EXPECT_EQ(data.toString(), "pong");
+        cnt2++;
+    };
+
+    for(int i(0); i<10; ++i)
+    {
+        ch2->send(Bytes("ping"), ep1);
+        ch3->send(Bytes("hello"), ep1);
+    }
+
+    for(int i(0); i<100 && (cnt2<10 || cntNew<10); ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(10, cntPeer);
+    EXPECT_EQ(10, cntNew);
+    EXPECT_EQ(10, cntTimestamp);
+    EXPECT_EQ(10, cnt2);
+
+    datagram::PeerStats stats = pc->stats().value();
+    EXPECT_EQ(10u, stats.receivedDatagrams);
+    EXPECT_EQ(40u, stats.receivedBytes);
+    EXPECT_EQ(10u, stats.sentDatagrams);
+    EXPECT_EQ(40u, stats.sentBytes);
+
+    bool closed = false;
+    pc->closed() += [&]
+    {
+        closed = true;
+    };
+    ch1->close();
+    EXPECT_TRUE(closed);
+}
@@ -9,12 +9,25 @@
 #include <dci/host.hpp>
 #include <dci/poll.hpp>
 #include "net.hpp"
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
 
 using namespace dci;
 using namespace dci::host;
 using namespace dci::cmt;
 using namespace dci::idl::net;
 
+namespace
+{
+    void sleep(int ms)
+    {
+        dci::poll::WaitableTimer t{std::chrono::milliseconds{ms}};
+        t.start();
+        t.wait();
+    }
+}
+
 /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
 TEST(module_net, resolve)
 {
@@ -62,6 +75,367 @@ TEST(module_net, resolve)
     }
 }
 
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, resolve_pool)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+    netHost->setResolveHostsFile("");//localhost is to go the regular way
+
+    netHost->setResolveWorkers(4);
+
+    std::vector<cmt::Future<IpEndpoint>> results;
+    for(int i(0); i<32; ++i)
+    {
+        //a name, literals do not reach the workers; distinct services are not coalesced
+        results.push_back(netHost->resolveIp("localhost:" + std::to_string(i+1)));
+    }
+
+    //all done, each with its own answer
+    for(std::size_t i(0); i<results.size(); ++i)
+    {
+        EXPECT_EQ(i+1, results[i].value().visit([](const auto& ep){return ep.port;}));
+    }
+
+    ResolveStats stats = netHost->resolveStats().value();
+    EXPECT_EQ(0u, stats.queued);
+    EXPECT_GE(stats.queuedMax, 1u);
+    EXPECT_GE(stats.workers, 1u);
+    EXPECT_LE(stats.workers, 4u);
+    EXPECT_GE(stats.executed, 32u);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, resolve_poolExpired)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+    netHost->setResolveHostsFile("");
+
+    //one worker, the tail of the queue outlives its deadline
+    netHost->setResolveWorkers(1);
+    netHost->setResolveTimeout(1);
+
+    std::vector<cmt::Future<IpEndpoint>> results;
+    for(int i(0); i<1024; ++i)
+    {
+        results.push_back(netHost->resolveIp("localhost:" + std::to_string(i+1)));
+    }
+
+    std::size_t timedOut = 0;
+    for(cmt::Future<IpEndpoint>& result : results)
+    {
+        try
+        {
+            result.value();
+        }
+        catch(const TimedOut&)
+        {
+            timedOut++;
+        }
+    }
+
+    sleep(10);
+
+    ResolveStats stats = netHost->resolveStats().value();
+    EXPECT_GE(timedOut, 1u);
+    EXPECT_GE(stats.expired, 1u);
+    EXPECT_LE(stats.expired, timedOut);
+    EXPECT_EQ(1u, stats.workers);
+    EXPECT_EQ(0u, stats.queued);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, resolve_literal)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    //all in place, without workers
+    cmt::Future<IpEndpoint> ip4 = netHost->resolveIp("127.0.0.1:8080");
+    ASSERT_TRUE(ip4.resolved());
+    EXPECT_EQ((Array<uint8, 4>{127,0,0,1}), ip4.value().get<Ip4Endpoint>().address.octets);
+    EXPECT_EQ(8080u, ip4.value().get<Ip4Endpoint>().port);
+
+    cmt::Future<Ip6Endpoint> ip6 = netHost->resolveIp6("[::1]:443");
+    ASSERT_TRUE(ip6.resolved());
+    EXPECT_EQ(1u, ip6.value().address.octets[15]);
+    EXPECT_EQ(443u, ip6.value().port);
+
+    Ip6Endpoint scoped = netHost->resolveIp6("fe80::a:1%7").value();
+    EXPECT_EQ((Array<uint8, 16>{0xfe,0x80,0,0,0,0,0,0,0,0,0,0,0,0x0a,0,1}), scoped.address.octets);
+    EXPECT_EQ(7u, scoped.address.linkId);
+
+    List<IpEndpoint> mapped = netHost->resolveAllIp("::ffff:10.0.0.1").value();
+    ASSERT_EQ(1u, mapped.size());
+    EXPECT_EQ((Array<uint8, 16>{0,0,0,0,0,0,0,0,0,0,0xff,0xff,10,0,0,1}), mapped.front().get<Ip6Endpoint>().address.octets);
+
+    cmt::Future<Ip4Endpoint> mismatch = netHost->resolveIp4("[::1]:1");
+    ASSERT_TRUE(mismatch.resolved());
+    EXPECT_THROW(mismatch.value(), ResolveError);
+
+    EXPECT_EQ(0u, netHost->resolveStats().value().executed);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, resolve_many)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    List<ResolveResult> results = netHost->resolveMany(List<String>{"localhost:80", "127.0.0.1:1", "", "localhost:81"}).value();
+    ASSERT_EQ(4u, results.size());
+
+    EXPECT_EQ("localhost:80", results[0].endpoint);
+    EXPECT_TRUE(results[0].error.empty());
+    ASSERT_FALSE(results[0].addresses.empty());
+    EXPECT_EQ(80u, results[0].addresses.front().visit([](const auto& ep){return ep.port;}));
+
+    EXPECT_TRUE(results[1].error.empty());
+    ASSERT_EQ(1u, results[1].addresses.size());
+    EXPECT_EQ(1u, results[1].addresses.front().get<Ip4Endpoint>().port);
+
+    EXPECT_TRUE(results[2].addresses.empty());
+
+    EXPECT_TRUE(results[3].error.empty());
+    ASSERT_FALSE(results[3].addresses.empty());
+    EXPECT_EQ(81u, results[3].addresses.front().visit([](const auto& ep){return ep.port;}));
+
+    //host goes away with a batch in flight, lookups are canceled or waited for
+    {
+        Host<> shortLived = manager->createService<Host<>>().value();
+        auto pending = shortLived->resolveMany(List<String>{"localhost:82", "dci-module-net-test.invalid:1"});
+    }
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, resolve_cache)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+    netHost->setResolveHostsFile("");//localhost is to go the regular way
+
+    netHost->setResolveCacheTtl(60000, 5000);
+
+    IpEndpoint first = netHost->resolveIp("localhost:80").value();
+
+    //answered in place, no worker involved
+    cmt::Future<IpEndpoint> second = netHost->resolveIp("localhost:80");
+    EXPECT_TRUE(second.resolved());
+    EXPECT_EQ(first, second.value());
+
+    ResolveStats stats = netHost->resolveStats().value();
+    EXPECT_EQ(1u, stats.cacheSize);
+    EXPECT_EQ(1u, stats.cacheHits);
+
+    List<ResolveCacheEntry> entries = netHost->resolveCacheEntries().value();
+    ASSERT_EQ(1u, entries.size());
+    EXPECT_EQ("localhost", entries.front().host);
+    EXPECT_EQ("80", entries.front().service);
+    EXPECT_EQ(1u, entries.front().hits);
+    EXPECT_FALSE(entries.front().negative);
+
+    netHost->flushResolveCache();
+    EXPECT_EQ(0u, netHost->resolveStats().value().cacheSize);
+
+    netHost->setResolveCacheSize(0);
+    netHost->resolveIp("localhost:80").value();
+    EXPECT_EQ(0u, netHost->resolveStats().value().cacheSize);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, resolve_coalesce)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+    netHost->setResolveHostsFile("");//localhost is to go the regular way
+
+    netHost->setResolveCacheSize(0);
+
+    //one lookup in flight, the rest follow it, each with its own value flavor
+    std::vector<cmt::Future<IpEndpoint>> singles;
+    std::vector<cmt::Future<List<IpEndpoint>>> lists;
+    for(int i(0); i<8; ++i)
+    {
+        singles.push_back(netHost->resolveIp("localhost:443"));
+        lists.push_back(netHost->resolveAllIp("localhost:443"));
+    }
+
+    for(auto& f : singles)
+    {
+        EXPECT_EQ(443u, f.value().visit([](const auto& ep){return ep.port;}));
+    }
+
+    for(auto& f : lists)
+    {
+        EXPECT_FALSE(f.value().empty());
+    }
+
+    ResolveStats stats = netHost->resolveStats().value();
+    EXPECT_EQ(15u, stats.coalesced);
+    EXPECT_EQ(1u, stats.executed);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, resolve_hosts)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    std::string path = "/tmp/dci-module-net-test-hosts-" + std::to_string(::getpid());
+    std::ofstream{path} << "# test\n10.9.8.7 alpha.test Alpha\nfe80::1%1 alpha.test\n";
+
+    netHost->setResolveHostsFile(path);
+
+    //in place, any case
+    cmt::Future<Ip4Endpoint> f = netHost->resolveIp4("ALPHA.test:80");
+    ASSERT_TRUE(f.resolved());
+    EXPECT_EQ((Array<uint8, 4>{10,9,8,7}), f.value().address.octets);
+    EXPECT_EQ(80u, f.value().port);
+    EXPECT_EQ(1u, netHost->resolveIp6("alpha.test:1").value().address.linkId);
+
+    //replaced by rename, as orchestration does
+    std::ofstream{path + ".new"} << "10.9.8.6 alpha.test\n";
+    std::rename((path + ".new").c_str(), path.c_str());
+
+    for(int i(0); i<1000 && !netHost->resolveStats().value().hostsReloads; ++i)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ((Array<uint8, 4>{10,9,8,6}), netHost->resolveIp4("alpha.test:80").value().address.octets);
+    EXPECT_EQ(1u, netHost->resolveStats().value().hostsNames);
+
+    netHost->setResolveHostsFile("");
+    std::remove(path.c_str());
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, resolve_stub)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    //local dns server: svc.test has A 10.1.2.3, big.test has A 10.4.5.6 but is truncated over udp; no AAAA, other names do not exist
+    auto answer = [](const std::string& query, bool tcp)
+    {
+        std::string name;
+        for(std::size_t pos(12); pos < query.size() && query[pos];)
+        {
+            std::size_t len = static_cast<uint8>(query[pos]);
+            if(!name.empty()) name += ".";
+            name += query.substr(pos+1, len);
+            pos += len + 1;
+        }
+        uint8 type = static_cast<uint8>(query[query.size()-3]);
+
+        bool known = "svc.test" == name || "big.test" == name;
+        bool truncated = "big.test" == name && !tcp;
+        bool withAddress = known && 1 == type && !truncated;
+
+        std::string response = query;
+        response[2] = static_cast<char>(truncated ? 0x83 : 0x81);
+        response[3] = static_cast<char>(known ? 0x80 : 0x83);
+        response[7] = withAddress ? 1 : 0;
+        if(withAddress)
+        {
+            response += std::string{"\xc0\x0c\x00\x01\x00\x01\x00\x00\x01\x2c\x00\x04", 12};
+            response += "svc.test" == name ? std::string{"\x0a\x01\x02\x03", 4} : std::string{"\x0a\x04\x05\x06", 4};
+        }
+
+        return response;
+    };
+
+    //tcp on the same port for truncated answers
+    stream::Server<> tcp = netHost->streamServer().value();
+    EXPECT_NO_THROW((tcp->listen(Ip4Endpoint{{127,0,0,1}, 0}).value()));
+    Ip4Endpoint dnsEndpoint = tcp->localEndpoint().value().get<Ip4Endpoint>();
+
+    int tcpQueries = 0;
+    std::vector<stream::Channel<>> tcpChannels;
+    tcp->accepted() += [&](stream::Channel<> ch)
+    {
+        std::size_t index = tcpChannels.size();
+        tcpChannels.push_back(ch);
+
+        auto in = std::make_shared<std::string>();
+        ch->received() += [&, index, in](Bytes data)
+        {
+            *in += data.toString();
+            if(in->size() < 2)
+            {
+                return;
+            }
+
+            std::size_t size = (std::size_t{static_cast<uint8>((*in)[0])} << 8) | static_cast<uint8>((*in)[1]);
+            if(in->size() < 2 + size)
+            {
+                return;
+            }
+
+            tcpQueries++;
+            std::string response = answer(in->substr(2, size), true);
+            in->clear();
+
+            tcpChannels[index]->send(Bytes(std::string{static_cast<char>(response.size() >> 8), static_cast<char>(response.size() & 0xff)} + response));
+        };
+        ch->startReceive();
+    };
+
+    datagram::Channel<> dns = netHost->datagramChannel().value();
+    EXPECT_NO_THROW((dns->bind(dnsEndpoint).value()));
+
+    int queries = 0;
+    dns->received() += [&](Bytes data, Endpoint from)
+    {
+        queries++;
+        dns->send(Bytes(answer(data.toString(), false)), from);
+    };
+
+    netHost->setResolveNameservers(List<IpEndpoint>{dnsEndpoint});
+    netHost->setResolveStub(true);
+
+    Ip4Endpoint ep = netHost->resolveIp4("svc.test:80").value();
+    EXPECT_EQ((Array<uint8, 4>{10,1,2,3}), ep.address.octets);
+    EXPECT_EQ(80u, ep.port);
+
+    List<IpEndpoint> all = netHost->resolveAllIp("svc.test:81").value();
+    ASSERT_EQ(1u, all.size());
+    EXPECT_EQ(81u, all.front().get<Ip4Endpoint>().port);
+
+    EXPECT_THROW(netHost->resolveIp("gone.test").value(), ResolveError);
+
+    //services are looked up in the parsed services file, unknown ones fail without a query
+    EXPECT_THROW(netHost->resolveIp4("svc.test:no-such-service").value(), ResolveError);
+
+    //literals and cached names do not go to the server
+    int before = queries;
+    EXPECT_EQ(8080u, netHost->resolveIp4("127.0.0.1:8080").value().port);
+    netHost->resolveIp4("svc.test:80").value();
+    EXPECT_EQ(before, queries);
+
+    //silent first server: its try times out by a share of the resolve timeout and the second one is asked,
+    //the truncated udp answer is asked again over tcp
+    datagram::Channel<> silent = netHost->datagramChannel().value();
+    EXPECT_NO_THROW((silent->bind(Ip4Endpoint{{127,0,0,1}, 0}).value()));
+    Ip4Endpoint silentEndpoint = silent->localEndpoint().value().get<Ip4Endpoint>();
+
+    int dropped = 0;
+    silent->received() += [&](Bytes, Endpoint)
+    {
+        dropped++;
+    };
+
+    netHost->setResolveTimeout(4000);
+    netHost->setResolveNameservers(List<IpEndpoint>{silentEndpoint, dnsEndpoint});
+
+    ep = netHost->resolveIp4("big.test:53").value();
+    EXPECT_EQ((Array<uint8, 4>{10,4,5,6}), ep.address.octets);
+    EXPECT_EQ(53u, ep.port);
+    EXPECT_GE(dropped, 1);
+    EXPECT_GE(tcpQueries, 1);
+}
+
 
 
 
@@ -258,6 +258,79 @@ TEST(module_net, stream_channelReadWrite)
     EXPECT_EQ(fin2, 1);
 }
 
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, stream_receiveExact)
+{
+    State state;
+    state.runServer();
+
+    sbs::Owner owner;
+
+    stream::Channel<> ch1;
+    state.srv->accepted() += owner * [&](stream::Channel<> ch)
+    {
+        ch1 = ch;
+    };
+
+    stream::Channel<> ch2 = state.cln->connect(state.srvEndpoint).value();
+
+    while(!ch1)
+    {
+        sleep(1);
+    }
+
+    ch2->send(Bytes{"01"});
+    ch2->send(Bytes{"23456"});
+    ch2->send(Bytes{"789abc"});
+
+    EXPECT_EQ(ch1->receiveExact(4).value().toString(), "0123");
+    EXPECT_EQ(ch1->receiveExact(9).value().toString(), "456789abc");
+
+    ch2->close();
+    EXPECT_THROW(ch1->receiveExact(1).value(), Error);
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, stream_timestamp)
+{
+    State state;
+    state.runServer();
+
+    sbs::Owner owner;
+
+    stream::Channel<> ch1;
+    state.srv->accepted() += owner * [&](stream::Channel<> ch)
+    {
+        ch1 = ch;
+    };
+
+    stream::Channel<> ch2 = state.cln->connect(state.srvEndpoint).value();
+
+    while(!ch1)
+    {
+        sleep(1);
+    }
+
+    EXPECT_NO_THROW((ch1->setOption(option::ReceiveTimestamp{true}).value()));
+
+    uint64 stamp = 0;
+    ch1->timestamp() += owner * [&](uint64 v)
+    {
+        stamp = v;
+    };
+
+    uint64 sent = static_cast<uint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    ch2->send(Bytes{"stamped"});
+
+    //the stamp comes before the data it belongs to
+    EXPECT_EQ(ch1->receiveExact(7).value().toString(), "stamped");
+    EXPECT_LE(sent, stamp);
+    EXPECT_GT(sent + 10'000'000'000ull, stamp);
+
+    ch2->close();
+    EXPECT_THROW(ch1->receiveExact(1).value(), Error);
+}
+
 /////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
 TEST(module_net, stream_serverClosed)
 {
@@ -281,6 +354,373 @@ TEST(module_net, stream_serverClosed)
     EXPECT_EQ(cnt, 1);
 }
 
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, stream_seqpacket)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    stream::Server<> srv = netHost->seqpacketServer().value();
+    stream::Client<> cln = netHost->seqpacketClient().value();
+
+    //local endpoints only
+    EXPECT_THROW((srv->listen(Ip4Endpoint{{127,0,0,1}, 0})).value(), InvalidArgument);
+
+    LocalEndpoint ep{"/tmp/dci-module-net-seqpacket"};
+    EXPECT_NO_THROW((srv->listen(ep).value()));
+
+    sbs::Owner owner;
+
+    stream::Channel<> ch1;
+    srv->accepted() += owner * [&](stream::Channel<> ch)
+    {
+        ch1 = ch;
+    };
+
+    stream::Channel<> ch2 = cln->connect(ep).value();
+
+    while(!ch1)
+    {
+        sleep(1);
+    }
+
+    std::vector<std::string> messages;
+    ch1->received() += owner * [&](Bytes data)
+    {
+        messages.push_back(data.toString());
+    };
+    ch1->startReceive();
+
+    ch2->send(Bytes{"01"});
+    ch2->send(Bytes{"23456"});
+    ch2->sendv(List<Bytes>{Bytes{"789"}, Bytes{"abc"}});
+
+    for(int i(0); i<100 && messages.size()<4; ++i)
+    {
+        sleep(1);
+    }
+
+    //boundaries are kept
+    EXPECT_EQ(messages, (std::vector<std::string>{"01", "23456", "789", "abc"}));
+
+    EXPECT_THROW(ch1->receiveExact(1).value(), OperationNotSupported);
+
+    ch2->close();
+    srv->close();
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, stream_seqpacketLarge)
+{
+    Manager* manager = testManager();
+    Host<> netHost = manager->createService<Host<>>().value();
+
+    stream::Server<> srv = netHost->seqpacketServer().value();
+    stream::Client<> cln = netHost->seqpacketClient().value();
+
+    LocalEndpoint ep{"/tmp/dci-module-net-seqpacketLarge"};
+    EXPECT_NO_THROW((srv->listen(ep).value()));
+
+    sbs::Owner owner;
+
+    stream::Channel<> ch1;
+    srv->accepted() += owner * [&](stream::Channel<> ch)
+    {
+        ch1 = ch;
+    };
+
+    stream::Channel<> ch2 = cln->connect(ep).value();
+
+    while(!ch1)
+    {
+        sleep(1);
+    }
+
+    //the message size is limited by the sender buffer
+    EXPECT_NO_THROW((ch2->setOption(option::SendBuf{1024*1024}).value()));
+
+    std::vector<std::string> messages;
+    ch1->received() += owner * [&](Bytes data)
+    {
+        messages.push_back(data.toString());
+    };
+
+    //far above the datagram receive buffer, mixed with small ones
+    std::string large1(300*1000, '\0');
+    std::string large2(200*1000, '\0');
+    for(std::size_t i(0); i<large1.size(); ++i)
+    {
+        large1[i] = static_cast<char>('a' + i % 26);
+    }
+    for(std::size_t i(0); i<large2.size(); ++i)
+    {
+        large2[i] = static_cast<char>('0' + i % 10);
+    }
+
+    //more chunks than iovecs
+    Bytes chained;
+    std::string chainedExpected;
+    for(int i(0); i<4096; ++i)
+    {
+        chained.end().write(Bytes{std::to_string(i % 10)});
+        chainedExpected += std::to_string(i % 10);
+    }
+
+    ch2->send(Bytes{"small1"});
+    ch2->send(Bytes{large1});
+    ch2->send(Bytes{"small2"});
+    ch2->send(Bytes{large2});
+    ch2->send(std::move(chained));
+
+    //queued up before the receiver starts, drained in batches together with the large ones
+    sleep(10);
+    ch1->startReceive();
+
+    for(int i(0); i<1000 && messages.size()<5; ++i)
+    {
+        sleep(1);
+    }
+
+    ASSERT_EQ(messages.size(), 5u);
+    EXPECT_EQ(messages[0], "small1");
+    EXPECT_TRUE(messages[1] == large1);
+    EXPECT_EQ(messages[2], "small2");
+    EXPECT_TRUE(messages[3] == large2);
+    EXPECT_EQ(messages[4], chainedExpected);
+
+    ch2->close();
+    srv->close();
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, stream_sharedRing)
+{
+    State state;
+
+    //smallest ring, wraps and fills many times
+    EXPECT_NO_THROW((state.srv->setOption(option::SharedRing{4096}).value()));
+    EXPECT_NO_THROW((state.cln->setOption(option::SharedRing{4096}).value()));
+
+    LocalEndpoint ep{"/tmp/dci-module-net-sharedRing"};
+    EXPECT_NO_THROW((state.srv->listen(ep).value()));
+
+    sbs::Owner owner;
+
+    stream::Channel<> ch1;
+    state.srv->accepted() += owner * [&](stream::Channel<> ch)
+    {
+        ch1 = ch;
+    };
+
+    stream::Channel<> ch2 = state.cln->connect(ep).value();
+
+    //client writes right after the offer, before the ack, goes through the socket
+    ch2->send(Bytes{"ping"});
+
+    while(!ch1)
+    {
+        sleep(1);
+    }
+
+    EXPECT_EQ(ch1->receiveExact(4).value().toString(), "ping");
+
+    //server took the offer before the ping, the ack went first
+    ch1->send(Bytes{"pong"});
+    EXPECT_EQ(ch2->receiveExact(4).value().toString(), "pong");
+    EXPECT_EQ(ch2->sharedRingReceived().value(), 4u);
+
+    std::string expected;
+    for(int i(0); i<4096; ++i)
+    {
+        ch2->send(Bytes{"0123456789abcdef"});
+        expected += "0123456789abcdef";
+    }
+
+    EXPECT_EQ(ch1->receiveExact(expected.size()).value().toString(), expected);
+
+    //payload went through the ring, not the socket
+    EXPECT_EQ(ch1->sharedRingReceived().value(), expected.size());
+
+    //close goes through the socket
+    ch2->close();
+    EXPECT_THROW(ch1->receiveExact(1).value(), Error);
+
+    state.srv->close();
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, stream_sharedRingPlainServer)
+{
+    State state;
+
+    //ring client, plain server
+    EXPECT_NO_THROW((state.cln->setOption(option::SharedRing{4096}).value()));
+
+    LocalEndpoint ep{"/tmp/dci-module-net-sharedRingPlainServer"};
+    EXPECT_NO_THROW((state.srv->listen(ep).value()));
+
+    sbs::Owner owner;
+
+    stream::Channel<> ch1;
+    state.srv->accepted() += owner * [&](stream::Channel<> ch)
+    {
+        ch1 = ch;
+    };
+
+    stream::Channel<> ch2 = state.cln->connect(ep).value();
+    ch2->send(Bytes{"ping"});
+
+    while(!ch1)
+    {
+        sleep(1);
+    }
+
+    //the offer is 16 bytes of plain data here, the client data follows it
+    EXPECT_EQ(ch1->receiveExact(16+4).value().toString().substr(16), "ping");
+
+    //first bytes back are not the ack, the client stays on the socket
+    ch1->send(Bytes{"pong"});
+    EXPECT_EQ(ch2->receiveExact(4).value().toString(), "pong");
+
+    ch2->send(Bytes{"more"});
+    EXPECT_EQ(ch1->receiveExact(4).value().toString(), "more");
+
+    EXPECT_EQ(ch2->sharedRingReceived().value(), 0u);
+
+    ch2->close();
+    EXPECT_THROW(ch1->receiveExact(1).value(), Error);
+
+    state.srv->close();
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, stream_sharedRingFallback)
+{
+    State state;
+
+    //ring server, plain client waiting for a greeting
+    EXPECT_NO_THROW((state.srv->setOption(option::SharedRing{4096}).value()));
+
+    LocalEndpoint ep{"/tmp/dci-module-net-sharedRingFallback"};
+    EXPECT_NO_THROW((state.srv->listen(ep).value()));
+
+    sbs::Owner owner;
+
+    stream::Channel<> ch1;
+    state.srv->accepted() += owner * [&](stream::Channel<> ch)
+    {
+        ch->send(Bytes{"hello"});
+        ch1 = ch;
+    };
+
+    stream::Channel<> ch2 = state.cln->connect(ep).value();
+    EXPECT_EQ(ch2->receiveExact(5).value().toString(), "hello");
+
+    while(!ch1)
+    {
+        sleep(1);
+    }
+
+    ch2->send(Bytes{"ping"});
+    EXPECT_EQ(ch1->receiveExact(4).value().toString(), "ping");
+
+    ch1->send(Bytes{"pong"});
+    EXPECT_EQ(ch2->receiveExact(4).value().toString(), "pong");
+
+    EXPECT_EQ(ch1->sharedRingReceived().value(), 0u);
+    EXPECT_EQ(ch2->sharedRingReceived().value(), 0u);
+
+    ch2->close();
+    EXPECT_THROW(ch1->receiveExact(1).value(), Error);
+
+    state.srv->close();
+}
+
+/////////0/////////1/////////2/////////3/////////4/////////5/////////6/////////7
+TEST(module_net, stream_inProcess)
+{
+    State state;
+    EXPECT_NO_THROW((state.srv->setOption(option::InProcess{true}).value()));
+    state.runServer();
+
+    sbs::Owner owner;
+
+    stream::Channel<> ch1;
+    state.srv->accepted() += owner * [&](stream::Channel<> ch)
+    {
+        ch1 = ch;
+    };
+
+    stream::Channel<> ch2 = state.cln->connect(state.srvEndpoint).value();
+
+    //wired at once, no handshake over sockets, but accepted comes from the loop as with sockets
+    EXPECT_TRUE(!ch1);
+    for(int i(0); i<100 && !ch1; ++i)
+    {
+        sleep(1);
+    }
+    EXPECT_TRUE(!!ch1);
+    EXPECT_EQ(ch2->remoteEndpoint().value().get<Ip4Endpoint>().port, state.srvEndpoint.get<Ip4Endpoint>().port);
+
+    uint64 sended = 0;
+    uint64 sendedWait = 0;
+    ch2->sended() += owner * [&](uint64 now, uint64 wait)
+    {
+        sended += now;
+        sendedWait = wait;
+    };
+
+    ch2->send(Bytes{"01"});
+    ch2->sendv(List<Bytes>{Bytes{"23456"}, Bytes{"789abc"}});
+
+    EXPECT_EQ(ch1->receiveExact(4).value().toString(), "0123");
+    EXPECT_EQ(ch1->receiveExact(9).value().toString(), "456789abc");
+    EXPECT_EQ(sended, 13u);
+    EXPECT_EQ(sendedWait, 0u);
+
+    //not consumed by the peer, the rest waits at the sender
+    std::string big(1024*1024, 'x');
+    ch2->send(Bytes{big});
+    for(int i(0); i<100 && sended < 13+256*1024; ++i)
+    {
+        sleep(1);
+    }
+    EXPECT_EQ(sended, 13u+256*1024);
+    EXPECT_EQ(sendedWait, big.size()-256*1024);
+
+    EXPECT_EQ(ch1->receiveExact(big.size()).value().toString(), big);
+    for(int i(0); i<100 && sendedWait; ++i)
+    {
+        sleep(1);
+    }
+    EXPECT_EQ(sended, 13u+big.size());
+    EXPECT_EQ(sendedWait, 0u);
+
+    std::string received;
+    ch2->received() += owner * [&](Bytes data)
+    {
+        received += data.toString();
+    };
+    ch2->startReceive();
+
+    ch1->send(Bytes{"pong"});
+    for(int i(0); i<100 && received.size()<4; ++i)
+    {
+        sleep(1);
+    }
+    EXPECT_EQ(received, "pong");
+
+    int closed = 0;
+    ch1->closed() += owner * [&]
+    {
+        closed++;
+    };
+
+    ch2->close();
+    EXPECT_THROW(ch1->receiveExact(1).value(), Error);
+    EXPECT_EQ(closed, 1);
+}
+
 
 
 